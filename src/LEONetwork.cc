@@ -0,0 +1,191 @@
+#include "LEONetwork.h"
+#include "utils/TleReader.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+Define_Module(LEONetwork);
+
+void LEONetwork::doBuildInside() {
+  // Static submodules and connections from the NED file
+  cModule::doBuildInside();
+
+  int firstId = par("firstSatelliteId").intValue();
+  nextSatelliteId = firstId >= 0 ? firstId : firstFreeAddress();
+  buildWalkerShell();
+
+  const char *tleFile = par("tleFile").stringValue();
+  if (tleFile[0] != '\0')
+    buildTleSatellites(tleFile);
+}
+
+// One above the largest ground station address of the NED part
+int LEONetwork::firstFreeAddress() {
+  int maxAddress = 0;
+  for (cModule::SubmoduleIterator it(this); !it.end(); ++it) {
+    cModule *submod = *it;
+    if (strcmp(submod->getClassName(), "GroundStation") == 0)
+      maxAddress = std::max(maxAddress, (int)submod->par("address").intValue());
+  }
+  return maxAddress + 1;
+}
+
+// Walker i:T/P/F shell as sat[0..T-1] (slot s of plane p is sat[p * S + s])
+// with +Grid ISLs. Gate vectors are sized once from the link list and
+// every connection gets its own index, so building is O(T) however large
+// the shell is.
+void LEONetwork::buildWalkerShell() {
+  int numPlanes = par("numPlanes").intValue();
+  int satsPerPlane = par("satsPerPlane").intValue();
+  int phasing = par("walkerPhasing").intValue();
+  if (numPlanes < 0 || satsPerPlane < 0)
+    throw cRuntimeError("numPlanes and satsPerPlane must not be negative");
+  int total = numPlanes * satsPerPlane;
+  if (total == 0)
+    return;
+  if (phasing < 0 || phasing >= numPlanes)
+    throw cRuntimeError("walkerPhasing must be in [0, numPlanes - 1], got %d",
+                        phasing);
+
+  const char *crossPlaneLinks = par("crossPlaneLinks").stringValue();
+  bool dynamicCrossPlane = strcmp(crossPlaneLinks, "dynamic") == 0;
+  if (!dynamicCrossPlane && strcmp(crossPlaneLinks, "static") != 0)
+    throw cRuntimeError("Unknown crossPlaneLinks '%s' (expected static or dynamic)",
+                        crossPlaneLinks);
+
+  double altitude = par("walkerAltitude").doubleValue();
+  double inclination = par("walkerInclination").doubleValue();
+  double raanSpacing = par("walkerRaanSpread").doubleValue() / numPlanes;
+  double slotSpacing = 360.0 / satsPerPlane;
+  double planePhase = phasing * 360.0 / total;
+
+  cModuleType *type = cModuleType::get("Satellite");
+  addSubmoduleVector("sat", total);
+  std::vector<cModule *> sats(total);
+
+  for (int i = 0; i < total; i++) {
+    int plane = i / satsPerPlane;
+    int slot = i % satsPerPlane;
+    cModule *sat = type->create("sat", this, i);
+
+    sat->par("satelliteId").setIntValue(nextSatelliteId + i);
+    sat->par("plane").setIntValue(plane);
+    sat->par("altitude").setDoubleValue(altitude);
+    sat->par("inclination").setDoubleValue(inclination);
+    sat->par("raan").setDoubleValue(plane * raanSpacing);
+    sat->par("initialAngle").setDoubleValue(slot * slotSpacing + plane * planePhase);
+
+    sat->finalizeParameters();
+    sats[i] = sat;
+  }
+
+  // +Grid: next slot in the plane (ring) and same slot in the next plane.
+  // Rings of two (planes or slots) would list the same pair twice.
+  // Dynamic cross-plane links are paired at run time by TopologyManager.
+  std::vector<std::pair<int, int>> links;
+  links.reserve(2 * total);
+  for (int plane = 0; plane < numPlanes; plane++) {
+    for (int slot = 0; slot < satsPerPlane; slot++) {
+      int self = plane * satsPerPlane + slot;
+      if (satsPerPlane > 2 || (satsPerPlane == 2 && slot == 0))
+        links.push_back({self, plane * satsPerPlane + (slot + 1) % satsPerPlane});
+      if (dynamicCrossPlane)
+        continue;
+      if (plane + 1 < numPlanes)
+        links.push_back({self, self + satsPerPlane});
+      else if (numPlanes > 2 && par("walkerSeamLinks").boolValue())
+        links.push_back({self, slot});
+    }
+  }
+
+  // radioOut[k] and radioIn[k] of a satellite lead to the same neighbour
+  std::vector<int> degree(total, 0);
+  for (const auto &link : links) {
+    degree[link.first]++;
+    degree[link.second]++;
+  }
+  for (int i = 0; i < total; i++) {
+    sats[i]->setGateSize("radioIn", degree[i]);
+    sats[i]->setGateSize("radioOut", degree[i]);
+  }
+
+  cChannelType *islType = cChannelType::get("InterSatelliteLink");
+  std::vector<int> nextGate(total, 0);
+  for (const auto &link : links) {
+    int a = link.first, b = link.second;
+    int gateA = nextGate[a]++, gateB = nextGate[b]++;
+    connectIsl(sats[a]->gate("radioOut$o", gateA), sats[b]->gate("radioIn$i", gateB), islType);
+    connectIsl(sats[b]->gate("radioOut$o", gateB), sats[a]->gate("radioIn$i", gateA), islType);
+  }
+
+  for (cModule *sat : sats)
+    sat->buildInside();
+
+  EV << "LEONetwork: Walker shell " << total << "/" << numPlanes << "/"
+     << phasing << " with " << links.size() << " ISLs, satellite ids "
+     << nextSatelliteId << ".." << nextSatelliteId + total - 1 << endl;
+  nextSatelliteId += total;
+}
+
+void LEONetwork::connectIsl(cGate *from, cGate *to, cChannelType *type) {
+  // Same sequence as the NED builder: the channel is initialized together
+  // with the network
+  cChannel *channel = type->create("channel");
+  from->connectTo(to, channel, true);
+  channel->finalizeParameters();
+}
+
+void LEONetwork::buildTleSatellites(const char *path) {
+  TleReader reader(path);
+  if (!reader.isOpen())
+    throw cRuntimeError("Cannot open TLE file '%s'", path);
+
+  int maxSatellites = par("maxTleSatellites").intValue();
+  // Default: right after the Walker shell
+  int firstId = par("firstTleSatelliteId").intValue();
+  if (firstId < 0)
+    firstId = nextSatelliteId;
+
+  // Only the selected element sets are kept, never the whole file. The
+  // first element set's epoch becomes simulation time 0.
+  std::vector<TleRecord> records;
+  std::vector<OrbitParams> orbits;
+  TleRecord record;
+  double referenceJD = 0;
+  while ((maxSatellites < 0 || (int)orbits.size() < maxSatellites) &&
+         reader.next(record)) {
+    if (orbits.empty())
+      referenceJD = record.epochJulianDate;
+    orbits.push_back(tleToOrbitParams(record, referenceJD));
+    records.push_back(record);
+  }
+
+  EV << "LEONetwork: " << orbits.size() << " satellites from " << path << " ("
+     << reader.getNumRejected() << " malformed element sets skipped)" << endl;
+
+  cModuleType *type = cModuleType::get("Satellite");
+  addSubmoduleVector("tleSat", orbits.size());
+
+  for (size_t i = 0; i < orbits.size(); i++) {
+    const OrbitParams &orbit = orbits[i];
+    cModule *sat = type->create("tleSat", this, i);
+
+    sat->par("satelliteId").setIntValue(firstId + i);
+    sat->par("altitude").setDoubleValue(orbit.semiMajorAxis - EARTH_RADIUS);
+    sat->par("inclination").setDoubleValue(orbit.inclination);
+    sat->par("raan").setDoubleValue(orbit.raan);
+    sat->par("argPerigee").setDoubleValue(orbit.argPerigee);
+    sat->par("initialAngle").setDoubleValue(orbit.trueAnomaly);
+    sat->par("eccentricity").setDoubleValue(orbit.eccentricity);
+    // The ephemeris propagates the element set itself with SGP4
+    sat->par("tleLine1").setStringValue(records[i].line1);
+    sat->par("tleLine2").setStringValue(records[i].line2);
+    sat->par("tleAge").setDoubleValue(
+        (referenceJD - records[i].epochJulianDate) * 86400.0);
+
+    sat->finalizeParameters();
+    sat->buildInside();
+    // initialize() is called by the kernel together with the NED modules
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef __MY_LEO_LEONETWORK_H
+#define __MY_LEO_LEONETWORK_H
+
+#include "omnetpp/cmodule.h"
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+// Network module. The NED part builds the ground segment; the satellites
+// (the Walker shell and, optionally, a TLE catalog) are added here, before
+// initialization, so every module sees the complete constellation.
+class LEONetwork : public cModule {
+
+private:
+  // Next free satelliteId; satellites are numbered above every ground
+  // station address so the two never share an address
+  int nextSatelliteId;
+
+  int firstFreeAddress();
+  void buildWalkerShell();
+  void connectIsl(cGate *from, cGate *to, cChannelType *type);
+  void buildTleSatellites(const char *path);
+
+protected:
+  virtual void doBuildInside() override;
+};
+
+#endif
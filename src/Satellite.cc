@@ -1,5 +1,7 @@
 #include "Satellite.h"
 #include "modules/DataPacket.h"
+#include "modules/ContactGraphRouter.h"
+#include "modules/RoutingController.h"
 #include "modules/RoutingMessage.h"
 #include "omnetpp/checkandcast.h"
 #include "omnetpp/chistogram.h"
@@ -7,7 +9,14 @@
 #include "omnetpp/cmodule.h"
 #include "omnetpp/coutvector.h"
 #include "omnetpp/csimulation.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <limits>
+
+namespace {
+const double UNREACHABLE = std::numeric_limits<double>::infinity();
+}
 
 void Satellite::initialize() {
 
@@ -16,19 +25,76 @@ void Satellite::initialize() {
   txFinishTimer = new cMessage("txFinishTimer");
   maxQueueSize = 1000; // Standard Router Buffer size
 
-  satelliteId = par("satelliteId").intValue();
-
-  orbitParams.semiMajorAxis = EARTH_RADIUS + par("altitude").doubleValue();
-  orbitParams.inclination = par("inclination");
-  orbitParams.raan = par("raan");
-  orbitParams.argPerigee = par("argPerigee");
-  orbitParams.trueAnomaly = par("initialAngle");
-  orbitParams.eccentricity = par("eccentricity");
-
   maxISLRange = par("maxISLRange");
+  positionUpdateInterval = par("positionUpdateInterval").doubleValue();
+  predictiveLinks = par("predictiveLinks").boolValue();
+  linkPredictionStep = par("linkPredictionStep").doubleValue();
+  linkPredictionHorizon = par("linkPredictionHorizon").doubleValue();
+
+  // Orbit and id come from the shared registry, read from our parameters
+  // once during discovery
+  ephemeris = check_and_cast<ConstellationEphemeris *>(
+      getParentModule()->getSubmodule("ephemeris"));
+  topology = check_and_cast<TopologyManager *>(
+      getParentModule()->getSubmodule("topology"));
+  ephemerisIndex = ephemeris->indexOf(this);
+  satelliteId = ephemeris->getSatelliteId(ephemerisIndex);
+  orbitParams = ephemeris->getOrbit(ephemerisIndex);
+
+  currentPosition = ephemeris->getPosition(ephemerisIndex);
+  neighborByNodeId.assign(ephemeris->getMaxAddress() + 1, -1);
+  // The controller may already have filled it while an earlier satellite
+  // initialized
+  if (fib.capacity() == 0)
+    fib.reset(ephemeris->getMaxAddress());
+
+  const char *routingMode = getParentModule()->par("routingMode").stringValue();
+  if (strcmp(routingMode, "centralized") == 0) {
+    routingController = check_and_cast<RoutingController *>(
+        getParentModule()->getSubmodule("routingController"));
+  } else if (strcmp(routingMode, "contactGraph") == 0) {
+    contactRouter = check_and_cast<ContactGraphRouter *>(
+        getParentModule()->getSubmodule("contactRouter"));
+  } else if (strcmp(routingMode, "distanceVector") == 0) {
+    triggeredUpdateDelay = par("triggeredUpdateDelay").doubleValue();
+    routingRefreshInterval = par("routingRefreshInterval").doubleValue();
+    routeTimeout = par("routeTimeout").doubleValue();
+    routeCostThreshold = par("routeCostThreshold").doubleValue();
+    dvRoutes.resize(ephemeris->getMaxAddress() + 1);
+    ownSeqNum = newerSeqNum(-1);
+    triggeredUpdateTimer = new cMessage("triggeredUpdate");
+    routingRefreshTimer = new cMessage("routingRefresh");
+    scheduleAt(simTime() + routingRefreshInterval, routingRefreshTimer);
+  } else {
+    throw cRuntimeError("Unknown routingMode '%s' (expected distanceVector, centralized "
+                        "or contactGraph)", routingMode);
+  }
 
-  currentPosition = calculateSatellitePositionECEF(orbitParams, 0.0);
-  updateNeighborList();
+  // Static ISLs: start from the current range state, then only react to
+  // the predicted crossings. Gates handed out by acquireLinkGate() may
+  // already carry a re-paired cross-plane ISL; those come and go with the
+  // epochs and are never predicted.
+  if (predictiveLinks) {
+    int numGates = gateSize("radioOut$o");
+    islUp.assign(numGates, false);
+    linkEvents.assign(numGates, nullptr);
+    for (int i = 0; i < numGates; i++) {
+      cGate *outGate = gate("radioOut$o", i);
+      if (!outGate->isConnected() || isDynamicLinkGate(i))
+        continue;
+      cModule *peer = outGate->getPathEndGate()->getOwnerModule();
+      if (ephemeris->kindOf(peer) != NodeKind::Satellite)
+        continue;
+      islUp[i] = calculateDistanceToSatellite(peer) <= maxISLRange;
+      topology->setPredictedRange(ephemerisIndex, i, islUp[i]);
+      linkEvents[i] = new cMessage("islLinkEvent");
+      scheduleLinkEvent(i);
+    }
+  }
+
+  linkRefreshTimer = new cMessage("linkRefresh");
+  topology->subscribe(ephemerisIndex, this);
+  refreshLinks();
   findNeighborSatellites();
 
   EV << "Satellite " << satelliteId << " initial position: ("
@@ -36,7 +102,7 @@ void Satellite::initialize() {
      << currentPosition.z << ") km" << endl;
 
   updateTimer = new cMessage("updatePosition");
-  scheduleAt(simTime() + 1.0, updateTimer);
+  scheduleAt(simTime() + positionUpdateInterval, updateTimer);
 
   // Traffic generation disabled - satellites are only routers
   trafficTimer = nullptr;
@@ -60,27 +126,31 @@ void Satellite::handleMessage(cMessage *msg) {
     processTxQueue();
   } else if (msg == updateTimer) {
 
-    double simTimeSeconds = simTime().dbl();
-
-    currentPosition =
-        calculateSatellitePositionECEF(orbitParams, simTimeSeconds);
-
-    // Update 2D Map Position (Mission Control View)
-    GeoCoord geo = ecefToGeo(currentPosition);
-    Position3D screenPos = geoToScreen(geo, 1000.0, 500.0);
-
-    getDisplayString().setTagArg("p", 0, (long)screenPos.x);
-    getDisplayString().setTagArg("p", 1, (long)screenPos.y);
-    // No Z needed for 2D map
+    // Map position is drawn by MapVisualizer (GUI runs only)
+    currentPosition = ephemeris->getPosition(ephemerisIndex);
 
-    updateNeighborList();
+    refreshLinks();
     findNeighborSatellites();
 
     EV << "Satellite " << satelliteId << " position: (" << currentPosition.x
        << ", " << currentPosition.y << ", " << currentPosition.z << ") km"
        << endl;
 
-    scheduleAt(simTime() + 1.0, updateTimer);
+    scheduleAt(simTime() + positionUpdateInterval, updateTimer);
+  } else if (msg == linkRefreshTimer) {
+    currentPosition = ephemeris->getPosition(ephemerisIndex);
+    refreshLinks();
+  } else if (msg == triggeredUpdateTimer) {
+    sendRoutingUpdate(false);
+  } else if (msg == routingRefreshTimer) {
+    refreshRoutingTable();
+    scheduleAt(simTime() + routingRefreshInterval, routingRefreshTimer);
+  } else if (msg->isSelfMessage() && dynamic_cast<DataPacket *>(msg) != nullptr) {
+    // Held for a contact that has started now
+    forwardByContactPlan(check_and_cast<DataPacket *>(msg));
+  } else if (msg->isSelfMessage()) {
+    // Only remaining self-messages are the per-gate ISL link events
+    handleLinkEvent(msg);
   } else if (dynamic_cast<RoutingMessage *>(msg) != nullptr) {
     processRoutingMessage(check_and_cast<RoutingMessage *>(msg));
   } else if (dynamic_cast<DataPacket *>(msg) != nullptr) {
@@ -100,26 +170,15 @@ void Satellite::handleMessage(cMessage *msg) {
     else {
       packet->hopCount++;
 
-      bool routeFound = false;
-      for (const auto &entry : routingTable) {
-        if (entry.destinationId == packet->destinationId) {
-          routeFound = true;
-          break;
-        }
-      }
-      if (routeFound) {
-        packetsForwarded++;
-        totalBitsForwarded += packet->getBitLength();
-
-        if (packetsForwarded == 1) {
-            firstPacketTime = simTime();
-        }
-        lastPacketTime = simTime();
-
-        routeMessage(packet, packet->destinationId);
+      const ForwardingTable::Entry *route = nullptr;
+      if (contactRouter) {
+        forwardByContactPlan(packet);
+      } else if ((route = fib.lookup(packet->destinationId)) != nullptr) {
+        recordForwarded(packet);
         EV << "Satellite " << satelliteId << " forwarding packet #"
            << packet->packetId << " to " << packet->destinationId
            << " (hops: " << packet->hopCount << ")" << endl;
+        routeMessage(packet, *route);
       } else {
         packetsDropped++;
         EV << "ERROR: Satellite " << satelliteId << " dropped packet #"
@@ -171,6 +230,44 @@ void Satellite::sendOrQueue(cMessage *msg, const char *gateName,
   processTxQueue();
 }
 
+int Satellite::acquireLinkGate() {
+  Enter_Method_Silent();
+  if (!freeLinkGates.empty()) {
+    int gateIndex = freeLinkGates.back();
+    freeLinkGates.pop_back();
+    return gateIndex;
+  }
+  int gateIndex = gateSize("radioIn");
+  setGateSize("radioIn", gateIndex + 1);
+  setGateSize("radioOut", gateIndex + 1);
+  dynamicLinkGates.resize(gateIndex + 1, false);
+  dynamicLinkGates[gateIndex] = true;
+  return gateIndex;
+}
+
+void Satellite::releaseLinkGate(int gateIndex) {
+  Enter_Method_Silent();
+  // Keep the queue order, minus the packets for this gate
+  int length = txQueue->getLength();
+  for (int k = 0; k < length; k++) {
+    cMessage *msg = (cMessage *)txQueue->pop();
+    if ((int)(intptr_t)msg->getContextPointer() == gateIndex) {
+      EV << "Satellite " << satelliteId << " dropping packet - gate " << gateIndex
+         << " released (link rewired)" << endl;
+      packetsDropped++;
+      delete msg;
+    } else {
+      txQueue->insert(msg);
+    }
+  }
+  // Never predicted, but the event must not outlive the link either
+  if (gateIndex < (int)linkEvents.size() && linkEvents[gateIndex]) {
+    cancelAndDelete(linkEvents[gateIndex]);
+    linkEvents[gateIndex] = nullptr;
+  }
+  freeLinkGates.push_back(gateIndex);
+}
+
 void Satellite::processTxQueue() {
   if (txQueue->isEmpty())
     return;
@@ -218,9 +315,20 @@ void Satellite::finish() {
   if (updateTimer) {
     cancelAndDelete(updateTimer);
   }
+  for (cMessage *event : linkEvents) {
+    if (event)
+      cancelAndDelete(event);
+  }
+  linkEvents.clear();
   if (txFinishTimer) {
     cancelAndDelete(txFinishTimer);
   }
+  if (linkRefreshTimer)
+    cancelAndDelete(linkRefreshTimer);
+  if (triggeredUpdateTimer)
+    cancelAndDelete(triggeredUpdateTimer);
+  if (routingRefreshTimer)
+    cancelAndDelete(routingRefreshTimer);
   delete txQueue;
 
   // === ROUTER STATISTICS ===
@@ -255,6 +363,12 @@ void Satellite::finish() {
   recordScalar("ForwardSuccessRate", forwardSuccessRate);
   recordScalar("PacketsForwarded", packetsForwarded);
   recordScalar("PacketsDropped", packetsDropped);
+  if (contactRouter)
+    recordScalar("PacketsHeld", packetsHeld);
+  if (!routingController && !contactRouter) {
+    recordScalar("RoutingMessagesSent", routingMessagesSent);
+    recordScalar("RoutingEntriesSent", routingEntriesSent);
+  }
 
   if (hopCountHist->getCount() > 0) {
     EV << "Hop Count - Mean: " << hopCountHist->getMean()
@@ -270,237 +384,417 @@ void Satellite::finish() {
 void Satellite::findNeighborSatellites() {
   // print neighbors.
   for (const auto &neighbor : neighbors) {
-    int neighborId = -1;
-    if (strcmp(neighbor.module->getClassName(), "Satellite") == 0) {
-      neighborId = neighbor.module->par("satelliteId").intValue();
-    } else {
-      neighborId = neighbor.module->par("address").intValue();
-    }
-    EV << "Neighbours of " << satelliteId << ": " << neighborId << endl;
+    EV << "Neighbours of " << satelliteId << ": " << neighbor.nodeId << endl;
   }
 }
 
 double Satellite::calculateDistanceToSatellite(cModule *otherSatellite) const {
-  Position3D myPos = currentPosition;
+  // Both positions come from the shared ephemeris pass of this tick
+  int otherIndex = ephemeris->indexOf(otherSatellite);
+  return ephemeris->distanceBetween(ephemerisIndex, otherIndex);
+}
 
-  OrbitParams otherParams;
-  otherParams.semiMajorAxis =
-      EARTH_RADIUS + otherSatellite->par("altitude").doubleValue();
-  otherParams.inclination = otherSatellite->par("inclination");
-  otherParams.raan = otherSatellite->par("raan");
-  otherParams.argPerigee = otherSatellite->par("argPerigee");
-  otherParams.trueAnomaly = otherSatellite->par("initialAngle");
-  otherParams.eccentricity = otherSatellite->par("eccentricity");
+void Satellite::updateNeighborList() {
+  // Usable links (range, Earth occlusion) come from the shared contact
+  // graph; our out-edges are our neighbours
+  const ContactGraph *graph = topology->getSnapshot();
+  uint32_t begin = graph->edgesBegin(ephemerisIndex);
+  uint32_t end = graph->edgesEnd(ephemerisIndex);
+
+  if (graph->epoch == neighborEpoch) {
+    // Same links, same order: only the distances moved
+    for (size_t k = 0; k < neighbors.size(); k++)
+      neighbors[k].distance = graph->distance[begin + k];
+  } else {
+    for (const auto &neighbor : neighbors)
+      neighborByNodeId[neighbor.nodeId] = -1;
+    neighbors.clear();
 
-  Position3D otherPos =
-      calculateSatellitePositionECEF(otherParams, simTime().dbl());
+    for (uint32_t e = begin; e < end; e++) {
+      int peer = graph->target[e];
+      NeighborInfo neighbor;
+      neighbor.module = topology->getNodeModule(peer);
+      neighbor.nodeId = graph->nodeAddress[peer];
+      neighbor.kind = graph->isSatellite(peer) ? NodeKind::Satellite : NodeKind::GroundStation;
+      neighbor.distance = graph->distance[e];
+      neighbor.gateIndex = graph->gate[e];
+      neighborByNodeId[neighbor.nodeId] = neighbors.size();
+      neighbors.push_back(neighbor);
+    }
+    neighborEpoch = graph->epoch;
+  }
 
-  return calculateDistance(myPos, otherPos);
 }
 
-void Satellite::updateNeighborList() {
-  neighbors.clear();
+void Satellite::refreshLinks() {
+  updateNeighborList();
+  // Deltas delivered while reading the snapshot are handled below
+  if (linkRefreshTimer && linkRefreshTimer->isScheduled())
+    cancelEvent(linkRefreshTimer);
 
-  // Iterate over all outgoing gates "radioOut$o"
-  int numGates = gateSize("radioOut$o");
+  // The controller recomputes every table once per contact graph epoch
+  if (routingController) {
+    routingController->update();
+    return;
+  }
+  // Routes come from the contact plan, nothing to exchange
+  if (contactRouter)
+    return;
 
-  for (int i = 0; i < numGates; i++) {
-    // Get the gate and check where it connects to
-    cGate *outGate = gate("radioOut$o", i);
+  // A stable topology produces no link-state events and hence no routing
+  // work or control traffic
+  if (linksChanged) {
+    linksChanged = false;
+    updateRoutingTable();
+  }
+}
 
-    if (!outGate->isConnected())
-      continue;
+void Satellite::linkStateChanged(const LinkChange &change) {
+  Enter_Method_Silent();
+  EV << "Satellite " << satelliteId << " link on gate " << change.gate
+     << (change.kind == LinkChangeKind::Up ? " up"
+         : change.kind == LinkChangeKind::Down ? " down" : " cost changed")
+     << endl;
+  linksChanged = true;
+  // React right away, after the rest of the burst has been delivered
+  if (!linkRefreshTimer->isScheduled())
+    scheduleAt(simTime(), linkRefreshTimer);
+}
 
-    // Follow the link to find the destination module
-    // Note: Since we have channels (InterSatelliteLink), we need to follow
-    // through the channel
-    cGate *destGate = outGate->getPathEndGate();
-    cModule *destMod = destGate->getOwnerModule();
-
-    // Check if it is a Satellite (ISL - Inter-Satellite Link)
-    if (strcmp(destMod->getClassName(), "Satellite") == 0) {
-      double distance = calculateDistanceToSatellite(destMod);
-
-      // Update ISL channel delay based on real distance
-      cChannel *channel = outGate->getChannel();
-      if (channel) {
-        // delay = distance / speed_of_light + processing
-        double propagationDelay = distance / 299792.458;  // km / (km/s) = seconds
-        double processingDelay = 0.001;  // 1ms processing delay
-        double totalDelay = propagationDelay + processingDelay;
-        channel->par("delay").setDoubleValue(totalDelay);
-      }
+// Predict when the ISL on 'gateIndex' next enters or leaves maxISLRange and
+// schedule its event. Without a crossing inside the horizon the event only
+// re-runs the prediction.
+void Satellite::scheduleLinkEvent(int gateIndex) {
+  cModule *peer = gate("radioOut$o", gateIndex)->getPathEndGate()->getOwnerModule();
+  const OrbitState &self = ephemeris->getOrbitState(ephemerisIndex);
+  const OrbitState &other = ephemeris->getOrbitState(ephemeris->indexOf(peer));
+
+  LinkPrediction next = predictRangeCrossing(
+      self, other, maxISLRange, simTime().dbl(), islUp[gateIndex],
+      linkPredictionHorizon, linkPredictionStep);
+
+  // kind: 1 = range crossing, 0 = horizon reached
+  cMessage *event = linkEvents[gateIndex];
+  event->setContextPointer((void *)(intptr_t)gateIndex);
+  event->setKind(next.found ? 1 : 0);
+  scheduleAt(next.time, event);
+}
 
-      // Only add to routing table if within range (simulating link break)
-      if (distance <= maxISLRange) {
-        NeighborInfo neighbor;
-        neighbor.module = destMod;
-        neighbor.distance = distance;
-        neighbor.gateIndex = i;
-        neighbors.push_back(neighbor);
-      }
-    }
-    // Or GroundStation
-    else if (strcmp(destMod->getClassName(), "GroundStation") == 0) {
-      // Calculate real distance to GS
-      GeoCoord gsGeo;
-      gsGeo.latitude = destMod->par("latitude").doubleValue();
-      gsGeo.longitude = destMod->par("longitude").doubleValue();
-      gsGeo.altitude = destMod->par("altitude").doubleValue();
-      Position3D gsPos = geoToECEF(gsGeo);
-      double distance = calculateDistance(currentPosition, gsPos);
+void Satellite::handleLinkEvent(cMessage *msg) {
+  int gateIndex = (int)(intptr_t)msg->getContextPointer();
 
-      NeighborInfo neighbor;
-      neighbor.module = destMod;
-      neighbor.distance = distance;
-      neighbor.gateIndex = i;
-      neighbors.push_back(neighbor);
+  if (msg->getKind() == 1) {
+    islUp[gateIndex] = !islUp[gateIndex];
+    EV << "Satellite " << satelliteId << " ISL on gate " << gateIndex
+       << (islUp[gateIndex] ? " UP" : " DOWN") << " at t=" << simTime() << endl;
 
-      // Add to Routing Table
-      int gsAddr = destMod->par("address").intValue();
-      RoutingEntry entry;
-      entry.destinationId = gsAddr;
-      entry.nextHopId = gsAddr;
-      entry.cost = distance;
-      routingTable.push_back(entry);
-    }
+    // Topology changed: refresh neighbours and tell them right away
+    topology->setPredictedRange(ephemerisIndex, gateIndex, islUp[gateIndex]);
+    currentPosition = ephemeris->getPosition(ephemerisIndex);
+    refreshLinks();
   }
+  scheduleLinkEvent(gateIndex);
+}
 
-  // updateRoutingTable(); // No longer needed to clear/rebuild, we built it
-  // incrementally above? Wait, the original code cleared routingTable at
-  // start of updateRoutingTable. Let's stick to the original flow:
-  // updateNeighborList finds physical neighbors. Then updateRoutingTable()
-  // builds the initial table from neighbors.
-  updateRoutingTable();
-  broadcastRoutingTable();
+const Satellite::NeighborInfo *Satellite::findNeighbor(int nodeId) const {
+  if (nodeId < 0 || nodeId >= (int)neighborByNodeId.size())
+    return nullptr;
+  int slot = neighborByNodeId[nodeId];
+  return slot >= 0 ? &neighbors[slot] : nullptr;
 }
 
-void Satellite::sendToNeighbor(cModule *targetSatellite, cMessage *msg) {
+void Satellite::recordForwarded(DataPacket *packet) {
+  packetsForwarded++;
+  totalBitsForwarded += packet->getBitLength();
 
-  for (const auto &neighbor : neighbors) {
-    if (neighbor.module == targetSatellite) {
-      if (gateSize("radioOut$o") > neighbor.gateIndex) {
-        sendOrQueue(msg, "radioOut$o", neighbor.gateIndex);
-        return;
-      }
-    }
+  if (packetsForwarded == 1) {
+      firstPacketTime = simTime();
   }
-  EV << "ERROR: Target satellite not in neighbor list! Sender: " << satelliteId
-     << " Target Module: " << targetSatellite->getFullName() << endl;
-  delete msg;
+  lastPacketTime = simTime();
 }
 
-void Satellite::updateRoutingTable() {
-  routingTable.clear();
+void Satellite::forwardByContactPlan(DataPacket *packet) {
+  ContactGraphRouter::Route route;
+  if (!contactRouter->route(ephemerisIndex, packet->destinationId, simTime().dbl(), route)) {
+    packetsDropped++;
+    EV << "ERROR: Satellite " << satelliteId << " dropped packet #"
+       << packet->packetId << " (no contact path to " << packet->destinationId
+       << ")" << endl;
+    delete packet;
+    return;
+  }
 
-  for (const auto &neighbor : neighbors) {
-    RoutingEntry entry;
+  // Store and forward: wait for the first contact of the route
+  if (route.departure > simTime().dbl()) {
+    packetsHeld++;
+    EV << "Satellite " << satelliteId << " holding packet #" << packet->packetId
+       << " for the contact to " << route.nextHop << " at t=" << route.departure << endl;
+    scheduleAt(route.departure, packet);
+    return;
+  }
 
-    if (strcmp(neighbor.module->getClassName(), "Satellite") == 0) {
-      entry.destinationId = neighbor.module->par("satelliteId").intValue();
-    } else {
-      // Must be GroundStation
-      entry.destinationId = neighbor.module->par("address").intValue();
-    }
+  // The plan is authoritative: the neighbour list is only refreshed every
+  // positionUpdateInterval, so fall back to the wiring for a new contact
+  const NeighborInfo *neighbor = findNeighbor(route.nextHop);
+  int gateIndex = neighbor ? neighbor->gateIndex : gateTowards(route.nextHopModule);
+  if (gateIndex < 0) {
+    packetsDropped++;
+    EV << "ERROR: Satellite " << satelliteId << " dropped packet #"
+       << packet->packetId << " (planned contact to " << route.nextHop
+       << " is not connected)" << endl;
+    delete packet;
+    return;
+  }
 
-    entry.nextHopId = entry.destinationId;
-    entry.cost = neighbor.distance;
+  recordForwarded(packet);
+  EV << "Satellite " << satelliteId << " forwarding packet #" << packet->packetId
+     << " to " << packet->destinationId << " via " << route.nextHop << endl;
+  sendOrQueue(packet, "radioOut$o", gateIndex);
+}
 
-    routingTable.push_back(entry);
+int Satellite::gateTowards(cModule *peer) {
+  for (int i = 0; i < gateSize("radioOut$o"); i++) {
+    cGate *outGate = gate("radioOut$o", i);
+    if (outGate->isConnected() && outGate->getPathEndGate()->getOwnerModule() == peer)
+      return i;
   }
-  EV << "Satellite " << satelliteId << " routing table updated with "
-     << routingTable.size() << " entries" << endl;
+  return -1;
 }
-void Satellite::routeMessage(cMessage *msg, int destinationId) {
-  for (const auto &entry : routingTable) {
-    if (entry.destinationId == destinationId) {
-      for (const auto &neighbor : neighbors) {
-        int neighborId = -1;
-        if (strcmp(neighbor.module->getClassName(), "Satellite") == 0) {
-          neighborId = neighbor.module->par("satelliteId").intValue();
-        } else {
-          neighborId = neighbor.module->par("address").intValue();
-        }
-
-        if (neighborId == entry.nextHopId) {
-          sendToNeighbor(neighbor.module, msg);
-          EV << "Satellite " << satelliteId << " routing message to "
-             << destinationId << " via " << entry.nextHopId << endl;
-          return;
-        }
-      }
-    }
+
+void Satellite::sendToNeighbor(const NeighborInfo &neighbor, cMessage *msg) {
+  // sendOrQueue validates the gate (it may have been disconnected by a
+  // handover since the neighbour list was built)
+  sendOrQueue(msg, "radioOut$o", neighbor.gateIndex);
+}
+
+void Satellite::routeMessage(cMessage *msg, const ForwardingTable::Entry &route) {
+  // sendOrQueue validates the gate (it may have been disconnected by a
+  // handover since the route was learned)
+  sendOrQueue(msg, "radioOut$o", route.gate);
+}
+
+// Smallest valid (even) sequence number above 'than', at least twice the
+// raw simulation time, so numbers also grow across re-originations
+int64_t Satellite::newerSeqNum(int64_t than) const {
+  int64_t seqNum = 2 * simTime().raw();
+  int64_t next = (than + 2) & ~(int64_t)1;
+  return seqNum > next ? seqNum : next;
+}
+
+void Satellite::markChanged(int destId) {
+  if (!dvRoutes[destId].changed) {
+    dvRoutes[destId].changed = true;
+    changedRoutes.push_back(destId);
   }
 }
 
-void Satellite::broadcastRoutingTable() {
-  RoutingMessage *rmsg = new RoutingMessage("RoutingUpdate");
-  rmsg->sourceId = satelliteId;
+void Satellite::setRoute(int destId, int64_t seqNum, const NeighborInfo &via, double viaCost) {
+  DvRoute &route = dvRoutes[destId];
+  double cost = viaCost + via.distance;
+  // A newer number or a slow cost drift alone is not news; it travels with
+  // the periodic table
+  if (route.seqNum < 0 || (route.seqNum & 1) || route.nextHop != via.nodeId ||
+      std::fabs(route.cost - cost) > routeCostThreshold)
+    markChanged(destId);
+  route.seqNum = seqNum;
+  route.cost = cost;
+  route.viaCost = viaCost;
+  route.nextHop = via.nodeId;
+  fib.set(destId, via.gateIndex, via.nodeId, cost);
+}
+
+void Satellite::breakRoute(int destId, int64_t seqNum) {
+  DvRoute &route = dvRoutes[destId];
+  if (route.seqNum >= 0 && !(route.seqNum & 1))
+    markChanged(destId);
+  route.seqNum = seqNum;
+  route.cost = UNREACHABLE;
+  route.viaCost = UNREACHABLE;
+  route.refreshed = simTime();
+  fib.remove(destId);
+}
+
+// The neighbour list changed: serve newly attached ground stations, break
+// the routes through neighbours that are gone, re-cost the others and
+// give new satellite neighbours our whole table
+void Satellite::updateRoutingTable() {
+  std::vector<int> satelliteNeighbors;
+  for (const auto &neighbor : neighbors) {
+    if (neighbor.kind == NodeKind::Satellite) {
+      satelliteNeighbors.push_back(neighbor.nodeId);
+      continue;
+    }
+    // We are the origin of the routes to the ground stations we serve
+    DvRoute &route = dvRoutes[neighbor.nodeId];
+    if (route.nextHop != neighbor.nodeId || route.seqNum < 0 || (route.seqNum & 1))
+      setRoute(neighbor.nodeId, newerSeqNum(route.seqNum), neighbor, 0.0);
+  }
+
+  for (int destId = 0; destId < (int)dvRoutes.size(); destId++) {
+    DvRoute &route = dvRoutes[destId];
+    if (route.seqNum < 0 || (route.seqNum & 1))
+      continue;
+    const NeighborInfo *via = findNeighbor(route.nextHop);
+    if (!via)
+      breakRoute(destId, route.seqNum + 1);
+    else
+      setRoute(destId, route.seqNum, *via, route.viaCost); // gate or cost may have moved
+  }
+
+  std::sort(satelliteNeighbors.begin(), satelliteNeighbors.end());
+  for (const auto &neighbor : neighbors) {
+    if (neighbor.kind == NodeKind::Satellite &&
+        !std::binary_search(previousNeighbors.begin(), previousNeighbors.end(), neighbor.nodeId))
+      sendRoutingUpdate(true, &neighbor);
+  }
+  previousNeighbors.swap(satelliteNeighbors);
+
+  if (!changedRoutes.empty())
+    scheduleTriggeredUpdate();
+  EV << "Satellite " << satelliteId << " routing table updated with "
+     << fib.size() << " entries" << endl;
+}
 
-  for (const auto &entry : routingTable) {
-    rmsg->destIds.push_back(entry.destinationId);
-    rmsg->costs.push_back(entry.cost);
+// Periodic: new sequence numbers for ourselves and the ground stations we
+// serve, expiry of routes the next hop stopped confirming, and the full
+// table to every neighbour (which also confirms our routes to them)
+void Satellite::refreshRoutingTable() {
+  ownSeqNum = newerSeqNum(ownSeqNum);
+  simtime_t now = simTime();
+  for (int destId = 0; destId < (int)dvRoutes.size(); destId++) {
+    DvRoute &route = dvRoutes[destId];
+    if (route.seqNum < 0)
+      continue;
+    bool broken = route.seqNum & 1;
+    const NeighborInfo *via = findNeighbor(route.nextHop);
+    if (!broken && route.nextHop == destId && via && via->kind == NodeKind::GroundStation)
+      route.seqNum = newerSeqNum(route.seqNum);
+    else if (!broken && now - route.refreshed > routeTimeout)
+      breakRoute(destId, route.seqNum + 1);
+    else if (broken && !route.changed && now - route.refreshed > routeTimeout)
+      route = DvRoute(); // forgotten; neighbours have heard it is broken
   }
-  rmsg->destIds.push_back(satelliteId);
-  rmsg->costs.push_back(0.0);
+  sendRoutingUpdate(true);
+}
+
+void Satellite::scheduleTriggeredUpdate() {
+  if (!triggeredUpdateTimer->isScheduled())
+    scheduleAt(simTime() + triggeredUpdateDelay, triggeredUpdateTimer);
+}
 
+void Satellite::sendRoutingUpdate(bool full, const NeighborInfo *only) {
   for (const auto &neighbor : neighbors) {
+    // Ground stations do not take part in routing
+    if (neighbor.kind != NodeKind::Satellite || (only && &neighbor != only))
+      continue;
+
+    RoutingMessage *rmsg = new RoutingMessage(full ? "RoutingUpdate" : "TriggeredUpdate");
+    rmsg->sourceId = satelliteId;
+    if (full || ownSeqChanged)
+      rmsg->addEntry(satelliteId, 0.0, ownSeqNum);
+
+    auto add = [&](int destId) {
+      const DvRoute &route = dvRoutes[destId];
+      if (route.seqNum < 0)
+        return;
+      // Split horizon with poisoned reverse
+      bool reverse = route.nextHop == neighbor.nodeId && destId != neighbor.nodeId;
+      rmsg->addEntry(destId, reverse ? UNREACHABLE : route.cost, route.seqNum);
+    };
+    if (full) {
+      for (int destId = 0; destId < (int)dvRoutes.size(); destId++)
+        add(destId);
+    } else {
+      for (int destId : changedRoutes)
+        add(destId);
+    }
 
-    RoutingMessage *msgCopy = rmsg->dup();
-    sendToNeighbor(neighbor.module, msgCopy);
+    if (rmsg->destIds.empty()) {
+      delete rmsg;
+      continue;
+    }
+    routingMessagesSent++;
+    routingEntriesSent += rmsg->destIds.size();
+    sendToNeighbor(neighbor, rmsg);
   }
 
-  delete rmsg;
-  EV << "Satellite " << satelliteId << " broadcasted routing table" << endl;
+  // Sent to everybody: nothing is pending any more
+  if (!only) {
+    for (int destId : changedRoutes)
+      dvRoutes[destId].changed = false;
+    changedRoutes.clear();
+    ownSeqChanged = false;
+    cancelEvent(triggeredUpdateTimer);
+  }
 }
+
 void Satellite::processRoutingMessage(RoutingMessage *msg) {
-  bool updated = false;
+  // The bus may have announced this neighbour before our periodic update
+  // picked it up
+  const NeighborInfo *source = findNeighbor(msg->sourceId);
+  if (!source && linksChanged) {
+    refreshLinks();
+    source = findNeighbor(msg->sourceId);
+  }
+  // Routes are stored by output gate, so only a current neighbour's
+  // table is usable
+  if (!source || dvRoutes.empty()) {
+    delete msg;
+    return;
+  }
 
   for (size_t i = 0; i < msg->destIds.size(); i++) {
     int destId = msg->destIds[i];
-    double receivedCost = msg->costs[i];
-
-    double linkCost = 0.0;
-    for (const auto &neighbor : neighbors) {
-      int neighborId = -1;
-      if (strcmp(neighbor.module->getClassName(), "Satellite") == 0) {
-        neighborId = neighbor.module->par("satelliteId").intValue();
-      } else {
-        neighborId = neighbor.module->par("address").intValue();
+    int64_t seqNum = msg->seqNums[i];
+    if (destId == satelliteId) {
+      // Someone declared us unreachable: answer with a newer number
+      if (seqNum > ownSeqNum) {
+        ownSeqNum = newerSeqNum(seqNum);
+        ownSeqChanged = true;
       }
+      continue;
+    }
+    if (destId < 0 || destId >= (int)dvRoutes.size())
+      continue;
 
-      if (neighborId == msg->sourceId) {
-        linkCost = neighbor.distance;
-        break;
+    DvRoute &route = dvRoutes[destId];
+    const NeighborInfo *direct = findNeighbor(destId);
+    if (direct && direct->kind == NodeKind::GroundStation) {
+      // We serve this station: ours is the authoritative route
+      if (seqNum > route.seqNum && route.nextHop == destId && !(route.seqNum & 1)) {
+        route.seqNum = newerSeqNum(seqNum);
+        markChanged(destId);
       }
+      continue;
     }
 
-    double totalCost = receivedCost + linkCost;
-
-    bool found = false;
-    for (auto &entry : routingTable) {
-      if (entry.destinationId == destId) {
-        if (totalCost < entry.cost) {
-          entry.nextHopId = msg->sourceId;
-          entry.cost = totalCost;
-          updated = true;
-        }
-        found = true;
-        break;
+    bool valid = route.seqNum >= 0 && !(route.seqNum & 1);
+    bool fromNextHop = valid && route.nextHop == msg->sourceId;
+    if ((seqNum & 1) || msg->costs[i] == UNREACHABLE) {
+      if ((seqNum & 1) && seqNum > route.seqNum) {
+        // Newer news of a break: older routes must not be used any more
+        breakRoute(destId, seqNum);
+      } else if (fromNextHop && seqNum >= route.seqNum) {
+        // Our next hop lost it, or routes through us (poisoned reverse)
+        breakRoute(destId, route.seqNum + 1);
       }
+      // Otherwise a poisoned entry for a route we do not take through the
+      // sender: nothing to learn
+      continue;
     }
-    if (!found && destId != satelliteId) {
-      RoutingEntry entry;
-      entry.destinationId = destId;
-      entry.nextHopId = msg->sourceId;
-      entry.cost = totalCost;
-      routingTable.push_back(entry);
-      updated = true;
+
+    double cost = msg->costs[i] + source->distance;
+    if (seqNum > route.seqNum ||
+        (seqNum == route.seqNum && (fromNextHop || cost < route.cost))) {
+      setRoute(destId, seqNum, *source, msg->costs[i]);
+      route.refreshed = simTime();
     }
   }
-  if (updated) {
+
+  if (!changedRoutes.empty() || ownSeqChanged) {
     EV << "Satellite " << satelliteId << " updated routing table from "
        << msg->sourceId << endl;
+    scheduleTriggeredUpdate();
   }
   delete msg;
 }
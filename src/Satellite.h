@@ -1,11 +1,15 @@
 #ifndef __MY_LEO_SATELLITE_H
 #define __MY_LEO_SATELLITE_H
 
+#include "modules/ConstellationEphemeris.h"
 #include "modules/RoutingMessage.h"
+#include "modules/TopologyManager.h"
 #include "omnetpp/chistogram.h"
 #include "omnetpp/cmessage.h"
 #include "omnetpp/coutvector.h"
 #include "omnetpp/cpacketqueue.h"
+#include "utils/ForwardingTable.h"
+#include "utils/LinkPredictor.h"
 #include "utils/PositionUtils.h"
 #include <omnetpp.h>
 #include <vector>
@@ -14,9 +18,13 @@ using namespace omnetpp;
 
 #include "omnetpp/cqueue.h"
 
+class RoutingController;
+class ContactGraphRouter;
+class DataPacket;
+
 // ... existing includes ...
 
-class Satellite : public cSimpleModule {
+class Satellite : public cSimpleModule, public LinkStateListener {
 
 private:
   int satelliteId;
@@ -31,29 +39,102 @@ private:
   void sendOrQueue(cMessage *msg, const char *gateName, int gateIndex);
   void processTxQueue();
 
+  // radioIn/radioOut indices given back by dynamic links, reused before
+  // the gate vectors are grown
+  std::vector<int> freeLinkGates;
+  // Per gate index: true if it was created by acquireLinkGate()
+  std::vector<bool> dynamicLinkGates;
+  bool isDynamicLinkGate(int gateIndex) const {
+    return gateIndex < (int)dynamicLinkGates.size() && dynamicLinkGates[gateIndex];
+  }
+
   OrbitParams orbitParams;
   // ... existing members ...
+  ConstellationEphemeris *ephemeris;
+  int ephemerisIndex; // our slot in the shared ephemeris
   Position3D currentPosition;
   cMessage *updateTimer;
+  double positionUpdateInterval;
+
+  // Predictive ISL availability: per ISL gate, whether the peer is within
+  // maxISLRange and the event at which that next changes
+  bool predictiveLinks;
+  double linkPredictionStep;
+  double linkPredictionHorizon;
+  std::vector<bool> islUp;
+  std::vector<cMessage *> linkEvents;
+  void scheduleLinkEvent(int gateIndex);
+  void handleLinkEvent(cMessage *msg);
   cMessage *trafficTimer;
 
   double maxISLRange;
+  TopologyManager *topology;
+  long neighborEpoch = -1; // contact graph epoch 'neighbors' was built from
+  // Set by the link-state bus; routing is only redone when it is set
+  bool linksChanged = true;
+  // Zero-delay refresh scheduled by the bus, one per burst of changes
+  cMessage *linkRefreshTimer = nullptr;
+  void refreshLinks();
 
   struct NeighborInfo {
     cModule *module;
+    int nodeId;    // satelliteId or ground station address
+    NodeKind kind;
     double distance;
     int gateIndex;
   };
   std::vector<NeighborInfo> neighbors;
-
-  struct RoutingEntry {
-    int destinationId;
-    int nextHopId;
-    double cost;
+  // Dense node id -> slot in 'neighbors' (-1 if not adjacent), so the
+  // per-packet next-hop lookup is one load instead of a scan
+  std::vector<int> neighborByNodeId;
+  const NeighborInfo *findNeighbor(int nodeId) const;
+
+  // Next-hop gate and cost per destination node id, filled by the
+  // distance-vector exchange or, if set, by the routing controller
+  ForwardingTable fib;
+  RoutingController *routingController = nullptr;
+  // Contact graph routing: next hop by earliest arrival from the contact
+  // plan; packets wait here for contacts that have not started yet
+  ContactGraphRouter *contactRouter = nullptr;
+  long packetsHeld = 0;
+  void forwardByContactPlan(DataPacket *packet);
+  int gateTowards(cModule *peer);
+  void recordForwarded(DataPacket *packet);
+  void routeMessage(cMessage *msg, const ForwardingTable::Entry &route);
+
+  // Distance-vector routing (DSDV style). Each destination's sequence
+  // number decides which information is newer, so stale routes cannot
+  // come back and count to infinity; changes are sent as triggered deltas
+  // and the full table only every routingRefreshInterval.
+  struct DvRoute {
+    int64_t seqNum = -1;   // even: valid, odd: broken, -1: unknown
+    double cost = 0;       // km, infinite when broken
+    double viaCost = 0;    // cost advertised by nextHop
+    int nextHop = -1;
+    simtime_t refreshed;   // last confirmed by nextHop (or broken)
+    bool changed = false;  // queued for the next triggered update
   };
-  std::vector<RoutingEntry> routingTable;
+  std::vector<DvRoute> dvRoutes; // per destination node id
+  std::vector<int> changedRoutes;
+  std::vector<int> previousNeighbors; // satellite neighbours at the last update
+  int64_t ownSeqNum = 0;
+  bool ownSeqChanged = false;
+  cMessage *triggeredUpdateTimer = nullptr;
+  cMessage *routingRefreshTimer = nullptr;
+  double triggeredUpdateDelay;
+  double routingRefreshInterval;
+  double routeTimeout;
+  double routeCostThreshold; // smaller cost changes wait for the refresh
+  long routingMessagesSent = 0;
+  long routingEntriesSent = 0;
+
+  int64_t newerSeqNum(int64_t than) const;
+  void setRoute(int destId, int64_t seqNum, const NeighborInfo &via, double viaCost);
+  void breakRoute(int destId, int64_t seqNum);
+  void markChanged(int destId);
   void updateRoutingTable();
-  void routeMessage(cMessage *msg, int destinationId);
+  void refreshRoutingTable();
+  void scheduleTriggeredUpdate();
 
   cOutVector *endToEndDelay;
   cOutVector *hopCountVector;
@@ -70,15 +151,33 @@ private:
   void updateNeighborList();
   double calculateDistanceToSatellite(cModule *otherSatellite) const;
 
-  void sendToNeighbor(cModule *targetsatellite, cMessage *msg);
+  void sendToNeighbor(const NeighborInfo &neighbor, cMessage *msg);
 
-  void broadcastRoutingTable();
+  // Changed routes to every satellite neighbour, or (full) the whole table
+  // to 'only' or to all of them; routes through a neighbour are poisoned
+  // towards it
+  void sendRoutingUpdate(bool full, const NeighborInfo *only = nullptr);
   void processRoutingMessage(RoutingMessage *msg);
 
 protected:
   virtual void initialize() override;
   virtual void handleMessage(cMessage *msg) override;
   virtual void finish() override;
+
+public:
+  virtual void linkStateChanged(const LinkChange &change) override;
+
+  // Written by the RoutingController in centralized routing mode
+  ForwardingTable &getForwardingTable() { return fib; }
+
+  // Gate pair (radioIn[k], radioOut[k]) for a link created at run time
+  // (ground station, re-paired cross-plane ISL). Gates of finished links
+  // are recycled, so the gate vectors stay at the peak number of
+  // simultaneous dynamic links.
+  int acquireLinkGate();
+  // The link on 'gateIndex' was disconnected; packets still queued for it
+  // are dropped so they cannot leak to the gate's next user
+  void releaseLinkGate(int gateIndex);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,540 @@
+#include "ConstellationEphemeris.h"
+#include "../utils/TleReader.h"
+#include "omnetpp/csimulation.h"
+#include <algorithm>
+#include <cstring>
+
+Define_Module(ConstellationEphemeris);
+
+void ConstellationEphemeris::initialize() {
+  // Satellites may call us before our own initialize() runs, so discovery
+  // and propagation are done lazily on first access.
+  discoverSatellites();
+  update();
+
+  EV << "ConstellationEphemeris tracking " << satellites.size()
+     << " satellites (" << numCircular << " circular, "
+     << sgp4Records.size() << " SGP4, "
+     << propagateBatchKernelName() << " kernel, "
+     << (pool ? pool->getNumThreads() : 1) << " thread(s))" << endl;
+}
+
+void ConstellationEphemeris::handleMessage(cMessage *) {
+  throw cRuntimeError("ConstellationEphemeris does not process messages");
+}
+
+void ConstellationEphemeris::finish() {
+  recordScalar("PropagationPasses", propagationPasses);
+  recordScalar("TableLookups", tableLookups);
+  recordScalar("KeplerIterations", keplerIterations);
+  recordScalar("SpatialIndexBuilds", gridBuilds);
+  recordScalar("OcclusionPasses", occlusionPasses);
+}
+
+void ConstellationEphemeris::discoverSatellites() {
+  if (discovered)
+    return;
+  discovered = true;
+
+  const char *solver = par("keplerSolver").stringValue();
+  if (strcmp(solver, "adaptive") == 0) {
+    adaptiveKepler = true;
+  } else if (strcmp(solver, "fixed") != 0) {
+    throw cRuntimeError("Unknown keplerSolver '%s' (expected fixed or adaptive)",
+                        solver);
+  }
+  keplerTolerance = par("keplerTolerance").doubleValue();
+
+  PerturbationModel model = PerturbationModel::TwoBody;
+  const char *perturbation = par("perturbationModel").stringValue();
+  if (strcmp(perturbation, "j2") == 0) {
+    model = PerturbationModel::J2Secular;
+  } else if (strcmp(perturbation, "twoBody") != 0) {
+    throw cRuntimeError(
+        "Unknown perturbationModel '%s' (expected twoBody or j2)", perturbation);
+  }
+  keplerMaxIterations = par("keplerMaxIterations").intValue();
+
+  int numThreads = par("numThreads").intValue();
+  if (numThreads < 1)
+    throw cRuntimeError("numThreads must be at least 1, got %d", numThreads);
+  if (numThreads > 1)
+    pool.reset(new ThreadPool(numThreads));
+  minSatellitesPerThread = par("minSatellitesPerThread").intValue();
+  spatialCellSize = par("spatialCellSize").doubleValue();
+  if (spatialCellSize <= 0)
+    throw cRuntimeError("spatialCellSize must be positive");
+  earthOcclusion = par("earthOcclusion").boolValue();
+  occlusionRadius = EARTH_RADIUS + par("grazingAltitude").doubleValue();
+
+  std::vector<cModule *> found;
+  std::vector<OrbitParams> foundOrbits;
+  std::vector<Sgp4Record> foundSgp4;
+  std::vector<uint8_t> fromTle, useSgp4;
+
+  cModule *network = getParentModule();
+  for (cModule::SubmoduleIterator it(network); !it.end(); ++it) {
+    cModule *submod = *it;
+
+    if (strcmp(submod->getClassName(), "GroundStation") == 0) {
+      GeoCoord geo;
+      geo.latitude = submod->par("latitude");
+      geo.longitude = submod->par("longitude");
+      geo.altitude = submod->par("altitude");
+      int address = submod->par("address").intValue();
+
+      groundSlotByModuleId[submod->getId()] = groundStations.size();
+      registerAddress(submod, address);
+      groundStations.push_back(submod);
+      groundPositions.push_back(geoToECEF(geo));
+      groundAddresses.push_back(address);
+      continue;
+    }
+
+    if (strcmp(submod->getClassName(), "Satellite") != 0) {
+      continue;
+    }
+
+    OrbitParams params;
+    params.semiMajorAxis =
+        EARTH_RADIUS + submod->par("altitude").doubleValue();
+    params.inclination = submod->par("inclination");
+    params.raan = submod->par("raan");
+    params.argPerigee = submod->par("argPerigee");
+    params.trueAnomaly = submod->par("initialAngle");
+    params.eccentricity = submod->par("eccentricity");
+
+    // Catalog satellites carry their element set
+    Sgp4Record sgp4 = Sgp4Record();
+    bool tle = submod->par("tleLine1").stdstringValue() != "";
+    bool sgp4Ok = false;
+    if (tle) {
+      TleRecord record;
+      if (!TleReader::parse(submod->par("tleLine1").stdstringValue(),
+                            submod->par("tleLine2").stdstringValue(), record))
+        throw cRuntimeError("%s: malformed element set",
+                            submod->getFullPath().c_str());
+      sgp4Ok = sgp4Init(record, submod->par("tleAge").doubleValue(), sgp4);
+      if (!sgp4Ok)
+        numDeepSpace++;
+    }
+
+    found.push_back(submod);
+    foundOrbits.push_back(params);
+    foundSgp4.push_back(sgp4);
+    fromTle.push_back(tle);
+    useSgp4.push_back(sgp4Ok);
+  }
+
+  // Circular orbits first, so each kind is one contiguous batch for the
+  // specialized kernels, then the SGP4 satellites
+  auto add = [&](size_t i, PerturbationModel slotModel) {
+    int satelliteId = found[i]->par("satelliteId").intValue();
+    slotByModuleId[found[i]->getId()] = satellites.size();
+    registerAddress(found[i], satelliteId);
+    satellites.push_back(found[i]);
+    satelliteIds.push_back(satelliteId);
+    orbits.push_back(foundOrbits[i]);
+    orbitStates.push_back(makeOrbitState(foundOrbits[i], slotModel));
+  };
+  for (OrbitKind kind : {OrbitKind::Circular, OrbitKind::Elliptical}) {
+    for (size_t i = 0; i < found.size(); i++) {
+      if (useSgp4[i] || orbitKindOf(foundOrbits[i]) != kind)
+        continue;
+      // Deep space element sets: Brouwer elements with at least the J2 drift
+      add(i, fromTle[i] ? PerturbationModel::J2Secular : model);
+      orbitBatch.push_back(orbitStates.back());
+    }
+    if (kind == OrbitKind::Circular)
+      numCircular = satellites.size();
+  }
+  numAnalytic = satellites.size();
+  for (size_t i = 0; i < found.size(); i++) {
+    if (!useSgp4[i])
+      continue;
+    add(i, PerturbationModel::J2Secular);
+    sgp4Records.push_back(foundSgp4[i]);
+  }
+  if (numDeepSpace > 0) {
+    EV << "WARNING: " << numDeepSpace << " deep space element set(s) (period >= "
+       << "225 min) use the J2 Kepler propagator, SDP4 is not implemented" << endl;
+  }
+
+  positions.resize(satellites.size());
+  keplerState.resize(satellites.size());
+
+  const char *tableFile = par("ephemerisFile").stringValue();
+  if (tableFile[0] != '\0')
+    openTable(tableFile);
+}
+
+void ConstellationEphemeris::registerAddress(cModule *node, int address) {
+  if (address < 0)
+    throw cRuntimeError("%s: negative address %d", node->getFullPath().c_str(),
+                        address);
+  // Routing state is keyed by address, so two nodes must never share one
+  auto registered = moduleByAddress.emplace(address, node);
+  if (!registered.second && registered.first->second != node)
+    throw cRuntimeError("%s: address %d is already used by %s",
+                        node->getFullPath().c_str(), address,
+                        registered.first->second->getFullPath().c_str());
+  addressByModuleId[node->getId()] = address;
+  if (address > maxAddress)
+    maxAddress = address;
+}
+
+void ConstellationEphemeris::openTable(const char *path) {
+  double step = par("ephemerisStep").doubleValue();
+  double duration = par("ephemerisDuration").doubleValue();
+  // The SGP4 slots' orbitStates are approximations: their element sets
+  // identify them
+  std::vector<OrbitState> analytic(orbitStates.begin(), orbitStates.begin() + numAnalytic);
+  uint64_t hash = EphemerisTable::hashOrbits(analytic, sgp4Records);
+
+  // Reuse a table from an earlier run if it matches this constellation
+  auto openMatching = [&]() {
+    if (!table.open(path))
+      return false;
+    const EphemerisTable::Header &h = table.getHeader();
+    if (h.numSatellites == satellites.size() && h.orbitHash == hash &&
+        h.step == step && table.getEndTime() >= duration) {
+      EV << "ConstellationEphemeris mapped table " << path << " ("
+         << h.numSamples << " samples)" << endl;
+      return true;
+    }
+    table.close();
+    return false;
+  };
+  if (openMatching())
+    return;
+
+  EV << "ConstellationEphemeris generating table " << path << " (" << duration
+     << " s, step " << step << " s)" << endl;
+  bool generated = EphemerisTable::generate(
+      path, satellites.size(), hash, duration, step,
+      [this](size_t i, double t, Position3D &pos, Position3D &vel) {
+        return stateAt(i, t, pos, vel);
+      });
+  if (generated && openMatching())
+    return;
+  // Another run of the sweep may have installed the table meanwhile
+  if (!openMatching())
+    throw cRuntimeError("Cannot generate ephemeris table '%s'", path);
+}
+
+void ConstellationEphemeris::propagateAll(double time) {
+  if (table.isOpen()) {
+    if (table.covers(time)) {
+      table.lookupAll(time, positions);
+      tableLookups++;
+      return;
+    }
+    if (!warnedTableRange) {
+      EV << "WARNING: t=" << time << "s is outside the ephemeris table, "
+         << "falling back to analytic propagation" << endl;
+      warnedTableRange = true;
+    }
+  }
+
+  size_t n = satellites.size();
+  size_t failed = 0;
+  if (!pool || n < 2 * minSatellitesPerThread) {
+    failed = propagateRange(time, 0, n, keplerIterations);
+  } else {
+    // Each thread propagates a contiguous slice and counts its own iterations
+    std::vector<long> iterations(pool->getNumThreads(), 0);
+    std::vector<size_t> failures(pool->getNumThreads(), 0);
+    pool->parallelFor(n, [&](size_t begin, size_t end, int thread) {
+      failures[thread] += propagateRange(time, begin, end, iterations[thread]);
+    });
+    for (long count : iterations)
+      keplerIterations += count;
+    for (size_t count : failures)
+      failed += count;
+  }
+  keplerState.warm = true;
+  if (failed > 0)
+    throw cRuntimeError("SGP4: %d satellite(s) decayed or got invalid elements at t=%gs",
+                        (int)failed, time);
+  propagationPasses++;
+}
+
+// Propagate slots [begin, end) into 'positions'. Only touches that slice of
+// the position and Kepler state arrays, so disjoint ranges may run in parallel.
+size_t ConstellationEphemeris::propagateRange(double time, size_t begin,
+                                              size_t end, long &iterations) {
+  size_t failed = 0;
+  if (end > numAnalytic) {
+    size_t first = std::max(begin, numAnalytic);
+    failed = propagateSgp4Batch(sgp4Records, time, positions, numAnalytic,
+                                first - numAnalytic, end - numAnalytic);
+    end = first;
+  }
+
+  size_t split = std::min(std::max(begin, numCircular), end);
+  if (begin < split)
+    propagateBatch<OrbitKind::Circular>(orbitBatch, time, positions, begin,
+                                        split);
+  if (split == end)
+    return failed;
+
+  if (adaptiveKepler) {
+    iterations += propagateBatchAdaptive(orbitBatch, time, positions, split,
+                                         end, keplerState, keplerTolerance,
+                                         keplerMaxIterations);
+  } else {
+    propagateBatch<OrbitKind::Elliptical>(orbitBatch, time, positions, split,
+                                          end);
+    iterations += 10 * (end - split);
+  }
+  return failed;
+}
+
+// Position and velocity of one slot, from the same propagator the batch uses
+bool ConstellationEphemeris::stateAt(size_t index, double time, Position3D &pos,
+                                     Position3D &vel) {
+  if (index >= numAnalytic)
+    return sgp4StateECEF(sgp4Records[index - numAnalytic], time, pos, vel);
+  calculateSatelliteStateECEF(orbitStates[index], time, pos, vel);
+  return true;
+}
+
+void ConstellationEphemeris::update() {
+  discoverSatellites();
+
+  if (positionsValid && lastUpdate == simTime())
+    return;
+
+  propagateAll(simTime().dbl());
+  lastUpdate = simTime();
+  positionsValid = true;
+}
+
+int ConstellationEphemeris::getNumSatellites() {
+  discoverSatellites();
+  return satellites.size();
+}
+
+int ConstellationEphemeris::indexOf(const cModule *satellite) {
+  discoverSatellites();
+  auto it = slotByModuleId.find(satellite->getId());
+  return it != slotByModuleId.end() ? it->second : -1;
+}
+
+cModule *ConstellationEphemeris::getSatellite(int index) {
+  discoverSatellites();
+  return satellites[index];
+}
+
+const OrbitParams &ConstellationEphemeris::getOrbit(int index) {
+  discoverSatellites();
+  return orbits[index];
+}
+
+const OrbitState &ConstellationEphemeris::getOrbitState(int index) {
+  discoverSatellites();
+  return orbitStates[index];
+}
+
+int ConstellationEphemeris::getSatelliteId(int index) {
+  discoverSatellites();
+  return satelliteIds[index];
+}
+
+int ConstellationEphemeris::getNumGroundStations() {
+  discoverSatellites();
+  return groundStations.size();
+}
+
+int ConstellationEphemeris::groundStationIndexOf(const cModule *groundStation) {
+  discoverSatellites();
+  auto it = groundSlotByModuleId.find(groundStation->getId());
+  return it != groundSlotByModuleId.end() ? it->second : -1;
+}
+
+cModule *ConstellationEphemeris::getGroundStation(int index) {
+  discoverSatellites();
+  return groundStations[index];
+}
+
+const Position3D &ConstellationEphemeris::getGroundStationPosition(int index) {
+  discoverSatellites();
+  return groundPositions[index];
+}
+
+int ConstellationEphemeris::getGroundStationAddress(int index) {
+  discoverSatellites();
+  return groundAddresses[index];
+}
+
+int ConstellationEphemeris::addressOf(const cModule *node) {
+  discoverSatellites();
+  auto it = addressByModuleId.find(node->getId());
+  return it != addressByModuleId.end() ? it->second : -1;
+}
+
+NodeKind ConstellationEphemeris::kindOf(const cModule *node) {
+  discoverSatellites();
+  if (slotByModuleId.count(node->getId()))
+    return NodeKind::Satellite;
+  if (groundSlotByModuleId.count(node->getId()))
+    return NodeKind::GroundStation;
+  return NodeKind::Unknown;
+}
+
+int ConstellationEphemeris::getMaxAddress() {
+  discoverSatellites();
+  return maxAddress;
+}
+
+Position3D ConstellationEphemeris::getPosition(int index) {
+  update();
+  Position3D pos;
+  pos.x = positions.x[index];
+  pos.y = positions.y[index];
+  pos.z = positions.z[index];
+  return pos;
+}
+
+Position3D ConstellationEphemeris::positionAt(int index, double time) {
+  discoverSatellites();
+  if (positionsValid && lastUpdate.dbl() == time) {
+    Position3D pos;
+    pos.x = positions.x[index];
+    pos.y = positions.y[index];
+    pos.z = positions.z[index];
+    return pos;
+  }
+  if (table.covers(time))
+    return table.lookup(index, time);
+  if (index >= (int)numAnalytic) {
+    Position3D pos;
+    if (!sgp4PositionECEF(sgp4Records[index - numAnalytic], time, pos))
+      throw cRuntimeError("SGP4: satellite %d decayed or got invalid elements at t=%gs",
+                          satelliteIds[index], time);
+    return pos;
+  }
+  return calculateSatellitePositionECEF(orbitStates[index], time);
+}
+
+double ConstellationEphemeris::distanceBetween(int a, int b) {
+  update();
+  double dx = positions.x[b] - positions.x[a];
+  double dy = positions.y[b] - positions.y[a];
+  double dz = positions.z[b] - positions.z[a];
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+double ConstellationEphemeris::distanceTo(int index, const Position3D &pos) {
+  update();
+  double dx = pos.x - positions.x[index];
+  double dy = pos.y - positions.y[index];
+  double dz = pos.z - positions.z[index];
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+const SpatialGrid &ConstellationEphemeris::getSpatialIndex() {
+  update();
+  if (!gridValid || gridTime != lastUpdate) {
+    grid.build(positions.x, positions.y, positions.z, spatialCellSize);
+    gridTime = lastUpdate;
+    gridValid = true;
+    gridBuilds++;
+  }
+  return grid;
+}
+
+int ConstellationEphemeris::nearestSatellite(const Position3D &pos,
+                                             double maxRange, double &distance,
+                                             int exclude) {
+  return getSpatialIndex().nearestWithin(pos, maxRange, distance, exclude);
+}
+
+void ConstellationEphemeris::satellitesWithin(const Position3D &pos,
+                                              double radius,
+                                              std::vector<int> &result) {
+  result.clear();
+  getSpatialIndex().forEachWithin(
+      pos, radius, [&](int index, double) { result.push_back(index); });
+}
+
+const std::vector<double> &ConstellationEphemeris::getX() {
+  update();
+  return positions.x;
+}
+
+const std::vector<double> &ConstellationEphemeris::getY() {
+  update();
+  return positions.y;
+}
+
+const std::vector<double> &ConstellationEphemeris::getZ() {
+  update();
+  return positions.z;
+}
+
+int ConstellationEphemeris::registerLink(int a, int b) {
+  discoverSatellites();
+  long long key = (long long)std::min(a, b) * satellites.size() + std::max(a, b);
+  auto it = linkByPair.find(key);
+  if (it != linkByPair.end())
+    return it->second;
+
+  int link = linkFrom.size();
+  linkByPair[key] = link;
+  linkFrom.push_back(a);
+  linkTo.push_back(b);
+  return link;
+}
+
+bool ConstellationEphemeris::isLinkClear(int link) {
+  update();
+  if (!earthOcclusion)
+    return true;
+  if (linkTime != lastUpdate) {
+    evaluatedLinks = 0;
+    linkTime = lastUpdate;
+  }
+  if ((size_t)link >= evaluatedLinks) {
+    size_t n = linkFrom.size() - evaluatedLinks;
+    checkLineOfSight(linkFrom.data() + evaluatedLinks, linkTo.data() + evaluatedLinks,
+                     n, newLinkClear);
+    linkClear.resize(evaluatedLinks);
+    linkClear.insert(linkClear.end(), newLinkClear.begin(), newLinkClear.end());
+    evaluatedLinks = linkFrom.size();
+  }
+  return linkClear[link];
+}
+
+void ConstellationEphemeris::checkLineOfSight(const std::vector<int> &from,
+                                              const std::vector<int> &to,
+                                              std::vector<uint8_t> &clear) {
+  checkLineOfSight(from.data(), to.data(), from.size(), clear);
+}
+
+void ConstellationEphemeris::checkLineOfSight(const int *from, const int *to,
+                                              size_t n, std::vector<uint8_t> &clear) {
+  update();
+  if (!earthOcclusion) {
+    clear.assign(n, 1);
+    return;
+  }
+
+  // Gather the endpoints contiguously, then one SIMD pass
+  linkSegments.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    linkSegments.ax[i] = positions.x[from[i]];
+    linkSegments.ay[i] = positions.y[from[i]];
+    linkSegments.az[i] = positions.z[from[i]];
+    linkSegments.bx[i] = positions.x[to[i]];
+    linkSegments.by[i] = positions.y[to[i]];
+    linkSegments.bz[i] = positions.z[to[i]];
+  }
+  segmentsClearOfSphere(linkSegments, occlusionRadius, clear);
+  occlusionPasses++;
+}
+
+bool ConstellationEphemeris::isLineOfSightClear(const Position3D &a, const Position3D &b) {
+  discoverSatellites();
+  return !earthOcclusion || segmentClearOfSphere(a, b, occlusionRadius);
+}
@@ -0,0 +1,171 @@
+#ifndef __MY_LEO_CONSTELLATIONEPHEMERIS_H_
+#define __MY_LEO_CONSTELLATIONEPHEMERIS_H_
+
+#include "../utils/EphemerisTable.h"
+#include "../utils/LineOfSight.h"
+#include "../utils/PositionUtils.h"
+#include "../utils/Sgp4.h"
+#include "../utils/SpatialGrid.h"
+#include "../utils/ThreadPool.h"
+#include "omnetpp/cmodule.h"
+#include <omnetpp.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace omnetpp;
+
+enum class NodeKind { Unknown, Satellite, GroundStation };
+
+// Shared ephemeris for the whole constellation.
+// Every satellite is propagated at most once per simulation tick into a
+// structure-of-arrays (x[], y[], z[]) that Satellites and GroundStations
+// read instead of propagating orbits themselves.
+// It is also the node registry: orbits, ground station positions and
+// network addresses are read from the modules' parameters once, so hot
+// paths never go through cPar.
+class ConstellationEphemeris : public cSimpleModule {
+
+private:
+  // Satellite registry (slot -> module / orbit)
+  std::vector<cModule *> satellites;
+  std::vector<OrbitParams> orbits;
+  std::vector<OrbitState> orbitStates; // derived once at registration
+  OrbitParamsSoA orbitBatch; // slots [0, numAnalytic)
+  size_t numCircular = 0; // slots [0, numCircular) have e == 0
+  // Slots [numAnalytic, end) are TLE satellites propagated with SGP4;
+  // their orbitStates are only a J2 approximation (link prediction)
+  size_t numAnalytic = 0;
+  std::vector<Sgp4Record> sgp4Records; // slot numAnalytic + k
+  int numDeepSpace = 0; // TLE satellites left to the Kepler propagator
+  std::vector<int> satelliteIds;
+  std::unordered_map<int, int> slotByModuleId;
+  bool discovered = false;
+
+  // Ground station registry (fixed in ECEF)
+  std::vector<cModule *> groundStations;
+  std::vector<Position3D> groundPositions;
+  std::vector<int> groundAddresses;
+  std::unordered_map<int, int> groundSlotByModuleId;
+
+  // Network address of every registered node (satelliteId or GS address)
+  std::unordered_map<int, int> addressByModuleId;
+  std::unordered_map<int, cModule *> moduleByAddress; // catches duplicates
+  int maxAddress = -1;
+
+  void registerAddress(cModule *node, int address);
+
+  // Kepler solver for the elliptical slots
+  bool adaptiveKepler = false;
+  double keplerTolerance;
+  int keplerMaxIterations;
+  KeplerStateSoA keplerState; // warm start, one entry per slot
+  long keplerIterations = 0;
+
+  // Worker threads for the analytic propagation (null = single-threaded)
+  std::unique_ptr<ThreadPool> pool;
+  size_t minSatellitesPerThread;
+
+  // Optional precomputed table replacing the analytic propagation
+  EphemerisTable table;
+  bool warnedTableRange = false;
+
+  // Positions at 'lastUpdate' (ECEF, km)
+  PositionSoA positions;
+  simtime_t lastUpdate;
+  bool positionsValid = false;
+
+  // Spatial index over 'positions', rebuilt lazily once per tick
+  SpatialGrid grid;
+  double spatialCellSize;
+  simtime_t gridTime;
+  bool gridValid = false;
+
+  // Satellite pairs checked for Earth occlusion, all in one batched pass
+  // per tick (lazily, on the first query). Links registered later in the
+  // same tick are evaluated as one extra batch of just the new entries.
+  bool earthOcclusion;
+  double occlusionRadius; // km from the Earth's centre
+  std::vector<int> linkFrom, linkTo;
+  std::unordered_map<long long, int> linkByPair;
+  SegmentSoA linkSegments;
+  std::vector<uint8_t> linkClear, newLinkClear;
+  size_t evaluatedLinks = 0; // linkClear is valid for [0, evaluatedLinks)
+  simtime_t linkTime;
+
+  long propagationPasses = 0;
+  long tableLookups = 0;
+  long gridBuilds = 0;
+  long occlusionPasses = 0;
+
+  void discoverSatellites();
+  void openTable(const char *path);
+  void propagateAll(double time);
+  // Returns the number of SGP4 satellites that could not be propagated
+  size_t propagateRange(double time, size_t begin, size_t end, long &iterations);
+  bool stateAt(size_t index, double time, Position3D &pos, Position3D &vel);
+
+protected:
+  virtual void initialize() override;
+  virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
+
+public:
+  // Propagate the constellation if simTime() moved since the last pass
+  void update();
+
+  int getNumSatellites();
+  int indexOf(const cModule *satellite);
+  cModule *getSatellite(int index);
+  const OrbitParams &getOrbit(int index);
+  const OrbitState &getOrbitState(int index);
+  int getSatelliteId(int index);
+
+  int getNumGroundStations();
+  int groundStationIndexOf(const cModule *groundStation);
+  cModule *getGroundStation(int index);
+  const Position3D &getGroundStationPosition(int index);
+  int getGroundStationAddress(int index);
+
+  // satelliteId or ground station address of a node, -1 if unknown
+  int addressOf(const cModule *node);
+  NodeKind kindOf(const cModule *node);
+  // Largest address in use: per-node tables indexed by address need
+  // getMaxAddress() + 1 entries
+  int getMaxAddress();
+
+  Position3D getPosition(int index);
+  // Position of one satellite at an arbitrary time, without propagating the
+  // rest of the constellation (per-packet link delays)
+  Position3D positionAt(int index, double time);
+  double distanceBetween(int a, int b);
+  double distanceTo(int index, const Position3D &pos);
+
+  // Range queries through the spatial index (sub-linear in the number of
+  // satellites). nearestSatellite() returns -1 if none is within range.
+  const SpatialGrid &getSpatialIndex();
+  int nearestSatellite(const Position3D &pos, double maxRange, double &distance,
+                       int exclude = -1);
+  void satellitesWithin(const Position3D &pos, double radius, std::vector<int> &result);
+
+  // Line of sight between satellites: false if the straight link passes
+  // below the grazing altitude. registerLink() returns the same id for
+  // (a, b) and (b, a); isLinkClear() evaluates every registered link at
+  // once when first called in a tick.
+  int registerLink(int a, int b);
+  bool isLinkClear(int link);
+  // One-off batch over candidate pairs (from[i], to[i]) at the current tick
+  void checkLineOfSight(const std::vector<int> &from, const std::vector<int> &to,
+                        std::vector<uint8_t> &clear);
+  void checkLineOfSight(const int *from, const int *to, size_t n,
+                        std::vector<uint8_t> &clear);
+  // Same test for two arbitrary points (contact planning at future times)
+  bool isLineOfSightClear(const Position3D &a, const Position3D &b);
+
+  // Raw SoA access (valid until the next tick)
+  const std::vector<double> &getX();
+  const std::vector<double> &getY();
+  const std::vector<double> &getZ();
+};
+
+#endif
@@ -0,0 +1,288 @@
+#include "ContactGraphRouter.h"
+#include "../utils/LinkPredictor.h"
+#include "MovingLinkChannel.h"
+#include "omnetpp/checkandcast.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+
+Define_Module(ContactGraphRouter);
+
+void ContactGraphRouter::initialize() {
+  // Planning the whole run is only worth it when the plan is used
+  if (strcmp(getParentModule()->par("routingMode").stringValue(), "contactGraph") != 0)
+    return;
+
+  // Satellites may call route() before our own initialize() runs
+  generate();
+
+  EV << "ContactGraphRouter planned " << plan.size() << " contacts over "
+     << planDuration << "s" << endl;
+}
+
+void ContactGraphRouter::handleMessage(cMessage *) {
+  throw cRuntimeError("ContactGraphRouter does not process messages");
+}
+
+void ContactGraphRouter::finish() {
+  recordScalar("PlannedContacts", plan.size());
+  recordScalar("RouteSearches", searches);
+  recordScalar("RouteLookups", lookups);
+}
+
+void ContactGraphRouter::generate() {
+  if (generated)
+    return;
+  generated = true;
+
+  ephemeris = check_and_cast<ConstellationEphemeris *>(
+      getParentModule()->getSubmodule("ephemeris"));
+  topology = check_and_cast<TopologyManager *>(
+      getParentModule()->getSubmodule("topology"));
+  planDuration = par("planDuration").doubleValue();
+  planStep = par("planStep").doubleValue();
+  guardTime = par("guardTime").doubleValue();
+  if (planStep <= 0)
+    throw cRuntimeError("planStep must be positive");
+  if (strcmp(getParentModule()->par("crossPlaneLinks").stringValue(), "static") != 0)
+    throw cRuntimeError("Contact graph routing needs crossPlaneLinks = \"static\": "
+                        "dynamic cross-plane ISLs are not known in advance");
+
+  const ContactGraph *graph = topology->getSnapshot();
+  numSatellites = graph->numSatellites;
+  nodeAddress = graph->nodeAddress;
+  nodeByAddress = graph->nodeByAddress;
+
+  std::vector<Contact> contacts;
+  planInterSatelliteLinks(contacts);
+  planGroundLinks(contacts);
+  plan.build(graph->numNodes, numSatellites, std::move(contacts));
+  routes.resize(numSatellites);
+}
+
+// Every static ISL, per direction: windows in which the link is usable
+// under the same rule as TopologyManager (sender's maxISLRange, Earth
+// occlusion). Sampled for all links at once per step; a change of state
+// between samples is located by bisection.
+void ContactGraphRouter::planInterSatelliteLinks(std::vector<Contact> &contacts) {
+  struct Link {
+    int from, to;
+    double range;
+    double processingDelay;
+    bool up;
+    double start;
+    double maxDistance;
+  };
+  std::vector<Link> links;
+  for (int v = 0; v < numSatellites; v++) {
+    cModule *sat = topology->getNodeModule(v);
+    double range = sat->par("maxISLRange").doubleValue();
+    for (int i = 0; i < sat->gateSize("radioOut"); i++) {
+      cGate *outGate = sat->gate("radioOut$o", i);
+      if (!outGate->isConnected())
+        continue;
+      int peer = topology->nodeOf(outGate->getPathEndGate()->getOwnerModule());
+      if (peer < 0 || peer >= numSatellites)
+        continue;
+      MovingLinkChannel *channel =
+          dynamic_cast<MovingLinkChannel *>(outGate->getTransmissionChannel());
+      links.push_back({v, peer, range, channel ? channel->getProcessingDelay() : 0,
+                       false, 0, 0});
+    }
+  }
+  if (links.empty())
+    return;
+
+  auto usable = [&](const Link &link, const Position3D &a, const Position3D &b, double &distance) {
+    distance = calculateDistance(a, b);
+    return distance <= link.range && ephemeris->isLineOfSightClear(a, b);
+  };
+  auto usableAt = [&](const Link &link, double t, double &distance) {
+    return usable(link, ephemeris->positionAt(link.from, t), ephemeris->positionAt(link.to, t),
+                  distance);
+  };
+  auto close = [&](Link &link, double end) {
+    if (end > link.start)
+      contacts.push_back({link.from, link.to, link.start, end,
+                          link.maxDistance / SPEED_OF_LIGHT + link.processingDelay});
+    link.up = false;
+  };
+
+  std::vector<Position3D> positions(numSatellites);
+  double previous = 0;
+  for (long k = 0;; k++) {
+    double t = std::min(k * planStep, planDuration);
+    for (int v = 0; v < numSatellites; v++)
+      positions[v] = ephemeris->positionAt(v, t);
+
+    for (Link &link : links) {
+      double distance;
+      bool up = usable(link, positions[link.from], positions[link.to], distance);
+      if (up != link.up && k > 0) {
+        // State at 'lo' is link.up, at 'hi' it is 'up'
+        double lo = previous, hi = t, d;
+        while (hi - lo > LINK_PREDICTION_TOLERANCE) {
+          double mid = 0.5 * (lo + hi);
+          if (usableAt(link, mid, d) == link.up)
+            lo = mid;
+          else
+            hi = mid;
+        }
+        if (link.up) {
+          close(link, hi);
+        } else {
+          link.up = true;
+          link.start = hi;
+          usableAt(link, hi, link.maxDistance);
+        }
+      } else if (up && k == 0) {
+        link.up = true;
+        link.start = 0;
+        link.maxDistance = distance;
+      }
+      if (up)
+        link.maxDistance = std::max(link.maxDistance, distance);
+    }
+    if (t >= planDuration)
+      break;
+    previous = t;
+  }
+  for (Link &link : links)
+    if (link.up)
+      close(link, planDuration);
+}
+
+// Serving satellite of every ground station over time, replaying the
+// station's handover policy (see GroundStation::performHandover()). All
+// stations are advanced in time order so the constellation is propagated
+// once per distinct handover time. The station -> satellite direction is
+// left out: stations are never transit hops and only satellites route.
+// The ground link's processing delay is the same for every route ending
+// at a station, so it does not affect the choice and is not added.
+void ContactGraphRouter::planGroundLinks(std::vector<Contact> &contacts) {
+  struct Station {
+    int node;
+    Position3D position;
+    double maxRange;
+    double handoverInterval;
+    bool predictive;
+    double predictionStep, predictionHorizon;
+    int current = -1;
+    LinkPrediction set;
+    double start = 0;
+    double maxDistance = 0;
+  };
+  int numStations = ephemeris->getNumGroundStations();
+  std::vector<Station> stations(numStations);
+  using Event = std::pair<double, int>;
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+  for (int g = 0; g < numStations; g++) {
+    cModule *gs = ephemeris->getGroundStation(g);
+    Station &s = stations[g];
+    s.node = topology->nodeOf(gs);
+    s.position = ephemeris->getGroundStationPosition(g);
+    s.maxRange = gs->par("maxRange").doubleValue();
+    s.handoverInterval = gs->par("handoverInterval").doubleValue();
+    s.predictive = gs->par("predictiveLinks").boolValue();
+    s.predictionStep = gs->par("linkPredictionStep").doubleValue();
+    s.predictionHorizon = gs->par("linkPredictionHorizon").doubleValue();
+    s.set.found = false;
+    s.set.time = 0;
+    events.push({0.0, g});
+  }
+
+  std::vector<Position3D> positions(numSatellites);
+  double positionsTime = -1;
+  // Nearest satellite within range, ties to the lowest slot (as
+  // ConstellationEphemeris::nearestSatellite())
+  auto nearest = [&](const Station &s, int exclude) {
+    int best = -1;
+    double bestDistance = s.maxRange;
+    for (int v = 0; v < numSatellites; v++) {
+      double d = calculateDistance(positions[v], s.position);
+      if (v != exclude && d <= s.maxRange && (best < 0 || d < bestDistance)) {
+        best = v;
+        bestDistance = d;
+      }
+    }
+    return best;
+  };
+  auto close = [&](Station &s, double end) {
+    if (s.current >= 0 && end > s.start)
+      contacts.push_back({s.current, s.node, s.start, end, s.maxDistance / SPEED_OF_LIGHT});
+  };
+
+  while (!events.empty()) {
+    double t = events.top().first;
+    int g = events.top().second;
+    events.pop();
+    Station &s = stations[g];
+    if (t >= planDuration) {
+      close(s, planDuration);
+      continue;
+    }
+    if (t != positionsTime) {
+      for (int v = 0; v < numSatellites; v++)
+        positions[v] = ephemeris->positionAt(v, t);
+      positionsTime = t;
+    }
+
+    int serving;
+    if (s.predictive && s.current >= 0)
+      serving = (!s.set.found || t < s.set.time) ? s.current : nearest(s, s.current);
+    else
+      serving = nearest(s, -1);
+
+    if (serving != s.current) {
+      close(s, t);
+      s.current = serving;
+      s.start = t;
+      s.maxDistance = 0;
+      s.set.found = false;
+      s.set.time = t;
+    }
+    if (s.current < 0) {
+      events.push({t + s.handoverInterval, g});
+      continue;
+    }
+    s.maxDistance = std::max(s.maxDistance, calculateDistance(positions[s.current], s.position));
+
+    if (s.predictive && t >= s.set.time)
+      s.set = predictRangeCrossing(ephemeris->getOrbitState(s.current), s.position, s.maxRange,
+                                   t, true, s.predictionHorizon, s.predictionStep);
+    // The connection lasts until the next check; ranges at the ends of
+    // the interval bound the distance on it
+    double next = s.predictive ? s.set.time : t + s.handoverInterval;
+    double end = std::min(next, planDuration);
+    s.maxDistance = std::max(s.maxDistance,
+        calculateDistance(ephemeris->positionAt(s.current, end), s.position));
+    events.push({next, g});
+  }
+}
+
+bool ContactGraphRouter::route(int satellite, int destination, double time, Route &result) {
+  Enter_Method_Silent();
+  generate();
+  lookups++;
+
+  if (destination < 0 || destination >= (int)nodeByAddress.size() || nodeByAddress[destination] < 0)
+    return false;
+  int target = nodeByAddress[destination];
+
+  ContactRoutes &r = routes[satellite];
+  if (r.source != satellite || time < r.time || time >= r.validUntil) {
+    plan.earliestArrival(satellite, time, r, heap);
+    searches++;
+  }
+  int hop = r.firstHop[target];
+  if (hop < 0)
+    return false;
+
+  result.nextHop = nodeAddress[hop];
+  result.nextHopModule = topology->getNodeModule(hop);
+  // Not before the contact has started on the other side as well (e.g. a
+  // ground station hands over at exactly that time)
+  result.departure = r.departure[target] > time ? r.departure[target] + guardTime : time;
+  return true;
+}
@@ -0,0 +1,72 @@
+#ifndef __MY_LEO_CONTACTGRAPHROUTER_H_
+#define __MY_LEO_CONTACTGRAPHROUTER_H_
+
+#include "../utils/ContactPlan.h"
+#include "ConstellationEphemeris.h"
+#include "TopologyManager.h"
+#include <omnetpp.h>
+#include <vector>
+
+using namespace omnetpp;
+
+// Contact Graph Routing, used when the network's routingMode is
+// "contactGraph". Orbits are deterministic, so the whole topology of the
+// run is known in advance: at the start the router precomputes a contact
+// plan for [0, planDuration), and satellites then ask it for the next hop
+// of every packet, by earliest arrival time, without any routing traffic.
+//
+// Contacts in the plan:
+//  - ISLs: every static satellite-to-satellite link, usable while within
+//    the sender's maxISLRange and clear of the Earth (sampled every
+//    planStep, crossings refined by bisection)
+//  - satellite to ground station: the serving satellite of each station,
+//    from a replay of GroundStation::performHandover() with the station's
+//    own parameters (nearest satellite every handoverInterval, or sticky
+//    until the predicted set time with predictiveLinks)
+//
+// Routes from a satellite are computed for all destinations at once and
+// cached until the next contact starts or ends.
+class ContactGraphRouter : public cSimpleModule {
+
+public:
+  struct Route {
+    int nextHop;           // satelliteId or ground station address
+    cModule *nextHopModule;
+    double departure;      // s; later than now: hold the packet until then
+  };
+
+private:
+  ConstellationEphemeris *ephemeris = nullptr;
+  TopologyManager *topology = nullptr;
+  bool generated = false;
+
+  double planDuration;
+  double planStep;
+  double guardTime;
+
+  ContactPlan plan;
+  int numSatellites;
+  std::vector<int> nodeAddress;
+  std::vector<int> nodeByAddress;
+  std::vector<ContactRoutes> routes; // per satellite, cached
+  std::vector<std::pair<double, int>> heap;
+
+  long searches = 0;
+  long lookups = 0;
+
+  void generate();
+  void planInterSatelliteLinks(std::vector<Contact> &contacts);
+  void planGroundLinks(std::vector<Contact> &contacts);
+
+protected:
+  virtual void initialize() override;
+  virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
+
+public:
+  // Next hop from 'satellite' (ephemeris slot) towards 'destination' for a
+  // packet there at 'time'. False if the plan has no path.
+  bool route(int satellite, int destination, double time, Route &result);
+};
+
+#endif
@@ -20,14 +20,20 @@ void GroundStation::initialize() {
 
   position = geoToECEF(geo);
 
-  // Set initial 2D Map position
-  Position3D screenPos = geoToScreen(geo, 1000.0, 500.0);
-  getDisplayString().setTagArg("p", 0, (long)screenPos.x);
-  getDisplayString().setTagArg("p", 1, (long)screenPos.y);
-
   maxRange = par("maxRange");
+  handoverInterval = par("handoverInterval").doubleValue();
+  predictiveLinks = par("predictiveLinks").boolValue();
+  linkPredictionStep = par("linkPredictionStep").doubleValue();
+  linkPredictionHorizon = par("linkPredictionHorizon").doubleValue();
+  currentSatelliteSet.found = false;
+  currentSatelliteSet.time = 0;
+  ephemeris = check_and_cast<ConstellationEphemeris *>(
+      getParentModule()->getSubmodule("ephemeris"));
+  topology = check_and_cast<TopologyManager *>(
+      getParentModule()->getSubmodule("topology"));
   currentSatellite = nullptr;
   currentSatGateIndex = -1;
+  groundLinkType = cChannelType::get("SatelliteToGroundLink");
 
   endToEndDelay = new cOutVector("endToEndDelay");
   packetsSent = 0;
@@ -43,20 +49,42 @@ void GroundStation::initialize() {
   maxQueueSize = 1000; 
   
   // DEBUG: Check actual Packet Size
-  int pSize = par("packetSize").intValue();
-  EV << "WARNING: GroundStation " << myAddress << " Packet Size is: " << pSize << " Bytes (" << (pSize*8.0)/1000000.0 << " Mb)" << endl;
+  packetSize = par("packetSize").intValue();
+  EV << "WARNING: GroundStation " << myAddress << " Packet Size is: " << packetSize << " Bytes (" << (packetSize*8.0)/1000000.0 << " Mb)" << endl;
 
   EV << "GroundStation " << myAddress << " initialized at position: (" << position.x << ", "
      << position.y << ", " << position.z << ") km" << endl;
 
-  handoverTimer = new cMessage("handoverTimer");
-  scheduleAt(simTime() + 1.0, handoverTimer);
-
   trafficTimer = new cMessage("trafficTimer");
   scheduleAt(simTime() + par("sendInterval"), trafficTimer);
 
   // perform to find first satellite to connect
   performHandover();
+
+  handoverTimer = new cMessage("handoverTimer");
+  scheduleAt(nextHandoverCheck(), handoverTimer);
+  topology->subscribe(topology->nodeOf(this), this);
+}
+
+void GroundStation::linkStateChanged(const LinkChange &change) {
+  Enter_Method_Silent();
+  if (change.kind != LinkChangeKind::Down || !currentSatellite ||
+      change.to != topology->nodeOf(currentSatellite))
+    return;
+
+  EV << "GroundStation " << myAddress << " lost its link to satellite "
+     << ephemeris->addressOf(currentSatellite) << ", handing over now" << endl;
+  // Also overrides a predicted set time that has not been reached yet
+  currentSatelliteSet.found = true;
+  currentSatelliteSet.time = simTime().dbl();
+  cancelEvent(handoverTimer);
+  scheduleAt(simTime(), handoverTimer);
+}
+
+simtime_t GroundStation::nextHandoverCheck() const {
+  if (predictiveLinks && currentSatellite)
+    return currentSatelliteSet.time; // set time, or re-predict at the horizon
+  return simTime() + handoverInterval;
 }
 
 void GroundStation::handleMessage(cMessage *msg) {
@@ -64,13 +92,13 @@ void GroundStation::handleMessage(cMessage *msg) {
       processTxQueue();
   } else if (msg == handoverTimer) { // handover timer
     performHandover();
-    scheduleAt(simTime() + 1.0, handoverTimer); // Check handover every 1s
+    scheduleAt(nextHandoverCheck(), handoverTimer);
   } else if (msg == trafficTimer) {
     // Generate Packet
     char pktName[32];
     snprintf(pktName, sizeof(pktName), "GS-%d-%ld", myAddress, packetsSent);
     DataPacket *packet = new DataPacket(pktName);
-    packet->setBitLength(par("packetSize").intValue() * 8); // Bytes to Bits
+    packet->setBitLength(packetSize * 8); // Bytes to Bits
     packet->sourceId = myAddress;
     
     // Target Logic
@@ -189,51 +217,33 @@ void GroundStation::finish() {
   EV << "GroundStation module finish" << endl;
 }
 
-cModule *GroundStation::findNearestSatellite() const {
-
-  cModule *network = getParentModule();
-  if (!network) {
-    EV << "ERROR: GroundStation couldnt find network!" << endl;
-    return nullptr;
-  }
-
-  cModule *nearestSat = nullptr;
-  double minDistance = maxRange;
-
-  for (cModule::SubmoduleIterator it(network); !it.end(); ++it) {
-    cModule *submod = *it;
-
-    if (strcmp(submod->getClassName(), "Satellite") != 0) {
-      continue;
-    }
+cModule *GroundStation::findNearestSatellite(const cModule *exclude) const {
 
-    OrbitParams orbitParams;
-    orbitParams.semiMajorAxis = EARTH_RADIUS + submod->par("altitude").doubleValue();
-    orbitParams.inclination = submod->par("inclination");
-    orbitParams.raan = submod->par("raan");
-    orbitParams.argPerigee = submod->par("argPerigee");
-    orbitParams.trueAnomaly = submod->par("initialAngle");
-    orbitParams.eccentricity = submod->par("eccentricity");
-
-    Position3D satPos = calculateSatellitePositionECEF(orbitParams, simTime().dbl());
-    double distance = calculateDistance(position, satPos);
-
-    if (distance <= maxRange && distance < minDistance) {
-      minDistance = distance;
-      nearestSat = submod;
-    }
-  }
-  return nearestSat;
+  // Grid query: only satellites in cells near us are looked at
+  double distance;
+  int nearest = ephemeris->nearestSatellite(
+      position, maxRange, distance, exclude ? ephemeris->indexOf(exclude) : -1);
+  return nearest >= 0 ? ephemeris->getSatellite(nearest) : nullptr;
 }
 
 void GroundStation::performHandover() {
-  cModule *nearestSat = findNearestSatellite();
+  cModule *nearestSat;
+  if (predictiveLinks && currentSatellite) {
+    // Sticky: stay until the serving satellite sets, then take the nearest
+    // other one (the setting one is exactly at maxRange now)
+    if (!currentSatelliteSet.found || simTime() < currentSatelliteSet.time)
+      nearestSat = currentSatellite;
+    else
+      nearestSat = findNearestSatellite(currentSatellite);
+  } else {
+    nearestSat = findNearestSatellite();
+  }
 
   if (nearestSat != currentSatellite) {
     // Disconnect from old satellite
     if (currentSatellite) {
       EV << "GroundStation " << myAddress << " handover FROM Satellite "
-         << currentSatellite->par("satelliteId").intValue() << endl;
+         << ephemeris->addressOf(currentSatellite) << endl;
       disconnectFromSatellite();
     }
 
@@ -243,10 +253,26 @@ void GroundStation::performHandover() {
     if (currentSatellite) {
       connectToSatellite(currentSatellite);
       EV << "GroundStation " << myAddress << " handover TO Satellite "
-         << currentSatellite->par("satelliteId").intValue() << endl;
+         << ephemeris->addressOf(currentSatellite) << endl;
     } else {
       EV << "GroundStation " << myAddress << " has NO satellite in range!" << endl;
     }
+    // Publish the rewiring now, so both satellites reroute immediately
+    // instead of on their next position update
+    topology->invalidate();
+    topology->getSnapshot();
+    currentSatelliteSet.found = false;
+    currentSatelliteSet.time = simTime().dbl();
+  }
+
+  // Predict when the serving satellite drops below maxRange
+  if (predictiveLinks && currentSatellite &&
+      simTime().dbl() >= currentSatelliteSet.time) {
+    const OrbitState &orbit =
+        ephemeris->getOrbitState(ephemeris->indexOf(currentSatellite));
+    currentSatelliteSet =
+        predictRangeCrossing(orbit, position, maxRange, simTime().dbl(), true,
+                             linkPredictionHorizon, linkPredictionStep);
   }
 }
 
@@ -260,45 +286,29 @@ void GroundStation::connectToSatellite(cModule *satellite) {
   cGate *gsOutGate = gate("groundLink$o", 0);
   cGate *gsInGate = gate("groundLink$i", 0);
 
-  // Expand satellite gate arrays
-  int satGateSize = satellite->gateSize("radioIn");
-  satellite->setGateSize("radioIn", satGateSize + 1);
-  satellite->setGateSize("radioOut", satGateSize + 1);
-  currentSatGateIndex = satGateSize;
+  // Free gate pair on the satellite (recycled from earlier handovers)
+  currentSatGateIndex = check_and_cast<Satellite *>(satellite)->acquireLinkGate();
 
   cGate *satInGate = satellite->gate("radioIn$i", currentSatGateIndex);
   cGate *satOutGate = satellite->gate("radioOut$o", currentSatGateIndex);
 
-  // Calculate real distance to satellite for accurate delay
-  OrbitParams satOrbit;
-  satOrbit.semiMajorAxis = EARTH_RADIUS + satellite->par("altitude").doubleValue();
-  satOrbit.inclination = satellite->par("inclination");
-  satOrbit.raan = satellite->par("raan");
-  satOrbit.argPerigee = satellite->par("argPerigee");
-  satOrbit.trueAnomaly = satellite->par("initialAngle");
-  satOrbit.eccentricity = satellite->par("eccentricity");
-
-  Position3D satPos = calculateSatellitePositionECEF(satOrbit, simTime().dbl());
-  double distance = calculateDistance(position, satPos);  // km
-
-  // Propagation delay = distance / speed_of_light + processing delay
-  // Speed of light = 299792.458 km/s
-  double propagationDelay = distance / 299792.458;  // seconds
-  double processingDelay = 0.001;  // 1ms processing
-  double totalDelay = propagationDelay + processingDelay;
+  double distance = ephemeris->distanceTo(ephemeris->indexOf(satellite), position);  // km
+  EV << "GS " << myAddress << " -> Sat " << ephemeris->addressOf(satellite)
+     << " distance: " << distance << " km" << endl;
 
-  EV << "GS " << myAddress << " -> Sat " << satellite->par("satelliteId").intValue()
-     << " distance: " << distance << " km, delay: " << (totalDelay * 1000) << " ms" << endl;
+  // Channels follow the satellite: MovingLinkChannel recomputes the
+  // propagation delay (distance / c + processing) for every packet.
+  // disconnect() deletes a gate's channel, so each link gets a new pair.
 
   // Create channels (GS -> Satellite)
-  cDatarateChannel *channelToSat = cDatarateChannel::create("gsToSat");
+  cDatarateChannel *channelToSat =
+      check_and_cast<cDatarateChannel *>(groundLinkType->create("gsToSat"));
   channelToSat->setDatarate(4e9);  // 4 Gbps
-  channelToSat->setDelay(totalDelay);
 
   // Create channels (Satellite -> GS)
-  cDatarateChannel *channelFromSat = cDatarateChannel::create("satToGs");
+  cDatarateChannel *channelFromSat =
+      check_and_cast<cDatarateChannel *>(groundLinkType->create("satToGs"));
   channelFromSat->setDatarate(4e9);
-  channelFromSat->setDelay(totalDelay);
 
   // Connect: GS -> Satellite
   gsOutGate->connectTo(satInGate, channelToSat);
@@ -309,7 +319,7 @@ void GroundStation::connectToSatellite(cModule *satellite) {
   channelFromSat->callInitialize();
 
   EV << "Dynamic link created: GS " << myAddress << " <-> Satellite "
-     << satellite->par("satelliteId").intValue()
+     << ephemeris->addressOf(satellite)
      << " (gate index: " << currentSatGateIndex << ")" << endl;
 }
 
@@ -332,6 +342,8 @@ void GroundStation::disconnectFromSatellite() {
     }
   }
 
+  if (currentSatellite && currentSatGateIndex >= 0)
+    check_and_cast<Satellite *>(currentSatellite)->releaseLinkGate(currentSatGateIndex);
   currentSatGateIndex = -1;
 }
 void GroundStation::sendToCurrentSatellite(cMessage *msg) {
@@ -1,7 +1,11 @@
 #ifndef __MY_LEO_GROUNDSTATION_H_
 #define __MY_LEO_GROUNDSTATION_H_
 
+#include "../utils/LinkPredictor.h"
 #include "../utils/PositionUtils.h"
+#include "../Satellite.h"
+#include "ConstellationEphemeris.h"
+#include "TopologyManager.h"
 #include "omnetpp/cmessage.h"
 #include "omnetpp/cmodule.h"
 #include "omnetpp/cqueue.h"
@@ -9,16 +13,29 @@
 
 using namespace omnetpp;
 
-class GroundStation : public cSimpleModule {
+class GroundStation : public cSimpleModule, public LinkStateListener {
 
 private:
   int myAddress;
   Position3D position;
   double maxRange;
+  int packetSize; // bytes
+  ConstellationEphemeris *ephemeris;
+  TopologyManager *topology;
   cModule *currentSatellite;     // current connected satellite
   int currentSatGateIndex;       // gate index on satellite side for this GS
+  cChannelType *groundLinkType;  // looked up once, not per handover
   cMessage *handoverTimer;
   cMessage *trafficTimer;
+  double handoverInterval;
+
+  // Predictive mode: keep the serving satellite until it leaves maxRange,
+  // at the predicted time, instead of re-checking every handoverInterval
+  bool predictiveLinks;
+  double linkPredictionStep;
+  double linkPredictionHorizon;
+  LinkPrediction currentSatelliteSet;
+  simtime_t nextHandoverCheck() const;
 
   // Dynamic connection management
   void connectToSatellite(cModule *satellite);
@@ -40,7 +57,7 @@ private:
   simtime_t firstPacketTime;
   simtime_t lastPacketTime;
 
-  cModule *findNearestSatellite() const;
+  cModule *findNearestSatellite(const cModule *exclude = nullptr) const;
 
   void performHandover();
   void sendToCurrentSatellite(cMessage *msg);
@@ -49,6 +66,10 @@ protected:
   virtual void initialize() override;
   virtual void handleMessage(cMessage *msg) override;
   virtual void finish() override;
+
+public:
+  // Loss of the serving link triggers an immediate handover
+  virtual void linkStateChanged(const LinkChange &change) override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef __MY_LEO_LINKSTATELISTENER_H_
+#define __MY_LEO_LINKSTATELISTENER_H_
+
+// Link-state deltas published by TopologyManager when a new contact graph
+// is built. Each directed link (node, output gate) produces at most one
+// change per rebuild:
+//   Up          - the link became usable (also: gate now leads elsewhere)
+//   Down        - it is no longer usable
+//   CostChanged - its length moved by more than costChangeThreshold since
+//                 the last published value (slow drift accumulates)
+enum class LinkChangeKind { Up, Down, CostChanged };
+
+struct LinkChange {
+  LinkChangeKind kind;
+  int from;          // node of the sending side (ContactGraph numbering)
+  int to;            // peer node
+  int gate;          // output gate index at 'from'
+  double distance;   // km; for Down, the last published distance
+};
+
+// Receives the changes of the links of the nodes it subscribed to, right
+// after the new snapshot became current.
+class LinkStateListener {
+public:
+  virtual ~LinkStateListener() {}
+  virtual void linkStateChanged(const LinkChange &change) = 0;
+};
+
+#endif
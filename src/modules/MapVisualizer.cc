@@ -0,0 +1,64 @@
+#include "MapVisualizer.h"
+#include "omnetpp/checkandcast.h"
+#include "omnetpp/cmodule.h"
+
+Define_Module(MapVisualizer);
+
+void MapVisualizer::initialize() {
+  // Headless runs (Cmdenv) never look at display strings
+  if (!par("enabled").boolValue() || !getEnvir()->isGUI())
+    return;
+
+  ephemeris = check_and_cast<ConstellationEphemeris *>(
+      getParentModule()->getSubmodule("ephemeris"));
+  updateInterval = par("updateInterval").doubleValue();
+  mapWidth = par("mapWidth").doubleValue();
+  mapHeight = par("mapHeight").doubleValue();
+
+  placeGroundStations();
+  placeSatellites();
+
+  refreshTimer = new cMessage("mapRefresh");
+  scheduleAt(simTime() + updateInterval, refreshTimer);
+}
+
+void MapVisualizer::handleMessage(cMessage *msg) {
+  if (msg != refreshTimer)
+    throw cRuntimeError("MapVisualizer does not process messages");
+
+  // Express mode does not redraw, so skip the work but keep the schedule
+  if (!getEnvir()->isExpressMode())
+    placeSatellites();
+
+  scheduleAt(simTime() + updateInterval, refreshTimer);
+}
+
+void MapVisualizer::finish() {
+  if (refreshTimer) {
+    cancelAndDelete(refreshTimer);
+    refreshTimer = nullptr;
+  }
+}
+
+void MapVisualizer::placeGroundStations() {
+  int n = ephemeris->getNumGroundStations();
+  for (int i = 0; i < n; i++) {
+    cModule *gs = ephemeris->getGroundStation(i);
+    GeoCoord geo = ecefToGeo(ephemeris->getGroundStationPosition(i));
+    Position3D screenPos = geoToScreen(geo, mapWidth, mapHeight);
+    gs->getDisplayString().setTagArg("p", 0, (long)screenPos.x);
+    gs->getDisplayString().setTagArg("p", 1, (long)screenPos.y);
+  }
+}
+
+void MapVisualizer::placeSatellites() {
+  int n = ephemeris->getNumSatellites();
+  for (int i = 0; i < n; i++) {
+    GeoCoord geo = ecefToGeo(ephemeris->getPosition(i));
+    Position3D screenPos = geoToScreen(geo, mapWidth, mapHeight);
+
+    cDisplayString &ds = ephemeris->getSatellite(i)->getDisplayString();
+    ds.setTagArg("p", 0, (long)screenPos.x);
+    ds.setTagArg("p", 1, (long)screenPos.y);
+  }
+}
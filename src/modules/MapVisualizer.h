@@ -0,0 +1,33 @@
+#ifndef __MY_LEO_MAPVISUALIZER_H_
+#define __MY_LEO_MAPVISUALIZER_H_
+
+#include "ConstellationEphemeris.h"
+#include "omnetpp/cmessage.h"
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+// Places satellites and ground stations on the 2D world map background.
+// Only active when a GUI is attached (Qtenv); under Cmdenv it schedules no
+// events and never touches a display string. Satellites are moved every
+// updateInterval from the shared ephemeris, independently of the
+// per-second position update.
+class MapVisualizer : public cSimpleModule {
+
+private:
+  ConstellationEphemeris *ephemeris;
+  cMessage *refreshTimer = nullptr;
+  double updateInterval;
+  double mapWidth;
+  double mapHeight;
+
+  void placeGroundStations();
+  void placeSatellites();
+
+protected:
+  virtual void initialize() override;
+  virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "MovingLinkChannel.h"
+#include "omnetpp/checkandcast.h"
+#include "omnetpp/cmodule.h"
+
+Define_Channel(MovingLinkChannel);
+
+void MovingLinkChannel::resolveEndpoints() {
+  cGate *sourceGate = getSourceGate();
+  cModule *ends[2] = {sourceGate->getOwnerModule(),
+                      sourceGate->getNextGate()->getOwnerModule()};
+
+  ephemeris = check_and_cast<ConstellationEphemeris *>(
+      ends[0]->getParentModule()->getSubmodule("ephemeris"));
+  for (int k = 0; k < 2; k++) {
+    satellite[k] = ephemeris->indexOf(ends[k]);
+    groundStation[k] = ephemeris->groundStationIndexOf(ends[k]);
+    if (satellite[k] < 0 && groundStation[k] < 0)
+      throw cRuntimeError("MovingLinkChannel: %s is neither a satellite nor a "
+                          "ground station",
+                          ends[k]->getFullPath().c_str());
+  }
+  processingDelay = par("processingDelay").doubleValue();
+  endpointsResolved = true;
+}
+
+Position3D MovingLinkChannel::endpointPosition(int end, double time) {
+  if (satellite[end] >= 0)
+    return ephemeris->positionAt(satellite[end], time);
+  return ephemeris->getGroundStationPosition(groundStation[end]);
+}
+
+double MovingLinkChannel::getDistance(simtime_t t) {
+  if (!endpointsResolved)
+    resolveEndpoints();
+  Position3D a = endpointPosition(0, t.dbl());
+  Position3D b = endpointPosition(1, t.dbl());
+  return calculateDistance(a, b);
+}
+
+double MovingLinkChannel::getProcessingDelay() {
+  if (!endpointsResolved)
+    resolveEndpoints();
+  return processingDelay;
+}
+
+cChannel::Result MovingLinkChannel::processMessage(cMessage *msg,
+                                                   const SendOptions &options,
+                                                   simtime_t t) {
+  // Datarate, transmission duration and disabled state as usual
+  Result result = cDatarateChannel::processMessage(msg, options, t);
+  if (!result.discard)
+    result.delay = getDistance(t) / SPEED_OF_LIGHT + processingDelay;
+  return result;
+}
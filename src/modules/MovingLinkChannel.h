@@ -0,0 +1,40 @@
+#ifndef __MY_LEO_MOVINGLINKCHANNEL_H_
+#define __MY_LEO_MOVINGLINKCHANNEL_H_
+
+#include "ConstellationEphemeris.h"
+#include "omnetpp/cdataratechannel.h"
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+// Datarate channel between two moving nodes (satellites or ground
+// stations). The propagation delay is computed for every transmission from
+// the endpoints' positions at that instant, plus a fixed processing delay,
+// instead of being written into the "delay" parameter periodically.
+class MovingLinkChannel : public cDatarateChannel {
+
+private:
+  ConstellationEphemeris *ephemeris = nullptr;
+  bool endpointsResolved = false;
+  // Per endpoint: satellite slot, or -1 and a ground station index
+  int satellite[2];
+  int groundStation[2];
+  double processingDelay;
+
+  void resolveEndpoints();
+  Position3D endpointPosition(int end, double time);
+
+public:
+  explicit MovingLinkChannel(const char *name = nullptr)
+      : cDatarateChannel(name) {}
+
+  // Current length of the link (km)
+  double getDistance(simtime_t t);
+  // Fixed part of the delay (s)
+  double getProcessingDelay();
+
+  virtual Result processMessage(cMessage *msg, const SendOptions &options,
+                                simtime_t t) override;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "RoutingController.h"
+#include "../Satellite.h"
+#include "omnetpp/checkandcast.h"
+#include <algorithm>
+#include <cstring>
+
+Define_Module(RoutingController);
+
+void RoutingController::initialize() {
+  // Idle unless selected: it would otherwise collect link changes forever
+  if (strcmp(getParentModule()->par("routingMode").stringValue(), "centralized") != 0)
+    return;
+
+  // Satellites may call update() before our own initialize() runs
+  discover();
+
+  EV << "RoutingController using " << (pool ? pool->getNumThreads() : 1)
+     << " thread(s), " << (incremental ? "incremental" : "full")
+     << " recomputation" << endl;
+}
+
+void RoutingController::handleMessage(cMessage *) {
+  throw cRuntimeError("RoutingController does not process messages");
+}
+
+void RoutingController::finish() {
+  recordScalar("RouteComputations", computations);
+  recordScalar("IncrementalRouteUpdates", incrementalUpdates);
+  recordScalar("RouteEntriesUpdated", entriesUpdated);
+  recordScalar("UnreachableRoutes", unreachableRoutes);
+}
+
+void RoutingController::discover() {
+  if (discovered)
+    return;
+  discovered = true;
+
+  topology = check_and_cast<TopologyManager *>(
+      getParentModule()->getSubmodule("topology"));
+
+  int numThreads = par("numThreads").intValue();
+  if (numThreads < 1)
+    throw cRuntimeError("numThreads must be at least 1, got %d", numThreads);
+  if (numThreads > 1)
+    pool.reset(new ThreadPool(numThreads));
+  minSourcesPerThread = par("minSourcesPerThread").intValue();
+  workspaces.resize(numThreads);
+  changedNodes.resize(numThreads);
+  incremental = par("incremental").boolValue();
+  maxIncrementalChanges = par("maxIncrementalChanges").intValue();
+
+  const ContactGraph *graph = topology->getSnapshot();
+  maxAddress = (int)graph->nodeByAddress.size() - 1;
+  for (int v = 0; v < graph->numSatellites; v++) {
+    Satellite *sat = check_and_cast<Satellite *>(topology->getNodeModule(v));
+    tables.push_back(&sat->getForwardingTable());
+  }
+  trees.resize(graph->numSatellites);
+  rowChanged.assign(graph->numNodes, 0);
+
+  if (incremental) {
+    for (int v = 0; v < graph->numNodes; v++)
+      topology->subscribe(v, this);
+  }
+}
+
+void RoutingController::linkStateChanged(const LinkChange &change) {
+  Enter_Method_Silent();
+  pendingChanges.push_back({change.from, change.to, change.distance,
+                            change.kind == LinkChangeKind::Down});
+}
+
+void RoutingController::update() {
+  Enter_Method_Silent();
+  discover();
+
+  // Reading the snapshot may rebuild it, which delivers the link changes
+  const ContactGraph *graph = topology->getSnapshot();
+  if (!built || (!incremental && graph->epoch != routedEpoch) ||
+      (int)pendingChanges.size() > maxIncrementalChanges) {
+    computeRoutes(*graph, true);
+  } else if (!pendingChanges.empty()) {
+    takePendingChanges();
+    computeRoutes(*graph, false);
+  }
+  pendingChanges.clear();
+  std::fill(rowChanged.begin(), rowChanged.end(), 0);
+  routedEpoch = graph->epoch;
+  built = true;
+}
+
+// Several rebuilds may have happened since the last update: keep only the
+// last change of every directed link, which describes its current state
+void RoutingController::takePendingChanges() {
+  std::stable_sort(pendingChanges.begin(), pendingChanges.end(),
+                   [](const EdgeChange &a, const EdgeChange &b) {
+                     return a.from != b.from ? a.from < b.from : a.to < b.to;
+                   });
+  size_t kept = 0;
+  for (size_t i = 0; i < pendingChanges.size(); i++) {
+    const EdgeChange &c = pendingChanges[i];
+    if (i + 1 < pendingChanges.size() && pendingChanges[i + 1].from == c.from &&
+        pendingChanges[i + 1].to == c.to)
+      continue;
+    pendingChanges[kept++] = c;
+    rowChanged[c.from] = 1;
+  }
+  pendingChanges.resize(kept);
+}
+
+void RoutingController::computeRoutes(const ContactGraph &graph, bool full) {
+  size_t n = graph.numSatellites;
+  long updated = 0;
+  if (!pool || n < 2 * (size_t)minSourcesPerThread) {
+    for (size_t s = 0; s < n; s++) {
+      routeFrom(graph, s, full, 0);
+      updated += changedNodes[0].size();
+    }
+  } else {
+    std::vector<long> counts(pool->getNumThreads(), 0);
+    pool->parallelFor(n, [&](size_t begin, size_t end, int thread) {
+      for (size_t s = begin; s < end; s++) {
+        routeFrom(graph, s, full, thread);
+        counts[thread] += changedNodes[thread].size();
+      }
+    });
+    for (long count : counts)
+      updated += count;
+  }
+  entriesUpdated += updated;
+
+  long unreachable = 0;
+  for (size_t s = 0; s < n; s++)
+    unreachable += graph.numNodes - 1 - (long)tables[s]->size();
+  unreachableRoutes += unreachable;
+  if (full)
+    computations++;
+  else
+    incrementalUpdates++;
+
+  EV << "RoutingController " << (full ? "computed" : "updated") << " routes for epoch "
+     << graph.epoch << " (" << pendingChanges.size() << " link changes, " << updated
+     << " entries written, " << unreachable << " unreachable pairs)" << endl;
+}
+
+// Runs on a pool thread: touches only the tree and table of 'source' and
+// the thread's own scratch space
+void RoutingController::routeFrom(const ContactGraph &graph, int source, bool full,
+                                  int thread) {
+  ShortestPathTree &tree = trees[source];
+  std::vector<int> &changed = changedNodes[thread];
+  changed.clear();
+
+  ForwardingTable &fib = *tables[source];
+  if (full) {
+    if (fib.capacity() != maxAddress + 1)
+      fib.reset(maxAddress);
+    else
+      fib.clear();
+    tree.build(graph, source, workspaces[thread], changed);
+  } else {
+    tree.update(graph, pendingChanges, workspaces[thread], changed);
+    // Our own links changed: their gates may have moved, so every entry
+    // is rewritten from the new row
+    if (rowChanged[source]) {
+      changed.clear();
+      for (int v = 0; v < graph.numNodes; v++)
+        if (v != source)
+          changed.push_back(v);
+    }
+  }
+
+  for (int v : changed)
+    installRoute(graph, source, v);
+}
+
+void RoutingController::installRoute(const ContactGraph &graph, int source, int node) {
+  ForwardingTable &fib = *tables[source];
+  int address = graph.nodeAddress[node];
+  int hop = trees[source].firstHopTo(node);
+  for (uint32_t e = graph.edgesBegin(source); hop >= 0 && e < graph.edgesEnd(source); e++) {
+    if (graph.target[e] == hop) {
+      fib.set(address, graph.gate[e], graph.nodeAddress[hop],
+              trees[source].distanceTo(node));
+      return;
+    }
+  }
+  fib.remove(address);
+}
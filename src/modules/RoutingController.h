@@ -0,0 +1,77 @@
+#ifndef __MY_LEO_ROUTINGCONTROLLER_H_
+#define __MY_LEO_ROUTINGCONTROLLER_H_
+
+#include "../utils/ForwardingTable.h"
+#include "../utils/ShortestPaths.h"
+#include "../utils/ThreadPool.h"
+#include "LinkStateListener.h"
+#include "TopologyManager.h"
+#include <memory>
+#include <omnetpp.h>
+#include <vector>
+
+using namespace omnetpp;
+
+// Centralized (SDN-style) routing, used when the network's routing
+// parameter is "centralized". It keeps one shortest-path tree per
+// satellite over the global contact graph and writes the resulting next
+// hops straight into the satellites' forwarding tables, so routes are
+// converged the moment the topology changes and no routing messages are
+// exchanged.
+//
+// The trees are maintained incrementally from the link-state bus: only
+// the subtrees affected by a link going up, down or changing cost are
+// recomputed, and only the forwarding entries that changed are rewritten,
+// so the cost follows the churn instead of the constellation size. Large
+// batches (and incremental = false) fall back to recomputing every tree.
+//
+// The per-source work is independent and is spread over a thread pool;
+// each source only writes its own tree and its satellite's table.
+class RoutingController : public cSimpleModule, public LinkStateListener {
+
+private:
+  TopologyManager *topology = nullptr;
+  bool discovered = false;
+
+  std::vector<ForwardingTable *> tables; // per satellite node
+  std::vector<ShortestPathTree> trees;   // per satellite node
+  int maxAddress;
+  bool built = false;
+  long routedEpoch = -1;
+
+  // Link changes received since the last update
+  bool incremental;
+  int maxIncrementalChanges;
+  std::vector<EdgeChange> pendingChanges;
+  std::vector<char> rowChanged; // per node: one of its own links changed
+
+  std::unique_ptr<ThreadPool> pool;
+  int minSourcesPerThread;
+  std::vector<ShortestPathWorkspace> workspaces; // per thread
+  std::vector<std::vector<int>> changedNodes;    // per thread
+
+  long computations = 0;
+  long incrementalUpdates = 0;
+  long entriesUpdated = 0;
+  long unreachableRoutes = 0; // satellite -> node pairs, summed over runs
+
+  void discover();
+  void takePendingChanges();
+  void computeRoutes(const ContactGraph &graph, bool full);
+  void routeFrom(const ContactGraph &graph, int source, bool full, int thread);
+  void installRoute(const ContactGraph &graph, int source, int node);
+
+protected:
+  virtual void initialize() override;
+  virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
+
+public:
+  virtual void linkStateChanged(const LinkChange &change) override;
+
+  // Bring all forwarding tables up to date with the contact graph. Cheap
+  // when nothing changed since the last call.
+  void update();
+};
+
+#endif
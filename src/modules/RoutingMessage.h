@@ -2,28 +2,41 @@
 #define __MY_LEO_ROUTINGMESSAGE_H_
 
 #include "omnetpp/cmessage.h"
+#include <cstdint>
 #include <omnetpp.h>
 #include <vector>
 
 using namespace omnetpp;
 
+// Distance-vector update: (destination, cost, sequence number) entries.
+// Sequence numbers are owned by the destination (or, for a ground
+// station, by the satellite serving it): even = reachable, odd = route
+// broken (cost infinite). A higher number is always newer.
 class RoutingMessage : public cMessage {
 
 public:
   int sourceId;
   std::vector<int> destIds;
   std::vector<double> costs;
+  std::vector<int64_t> seqNums;
 
   RoutingMessage(const char *name = nullptr) : cMessage(name) {}
   RoutingMessage(const RoutingMessage &other) : cMessage(other) {
     sourceId = other.sourceId;
     destIds = other.destIds;
     costs = other.costs;
+    seqNums = other.seqNums;
   }
 
   virtual RoutingMessage *dup() const override {
     return new RoutingMessage(*this);
   }
+
+  void addEntry(int destId, double cost, int64_t seqNum) {
+    destIds.push_back(destId);
+    costs.push_back(cost);
+    seqNums.push_back(seqNum);
+  }
 };
 
-#endif
\ No newline at end of file
+#endif
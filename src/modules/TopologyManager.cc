@@ -0,0 +1,392 @@
+#include "TopologyManager.h"
+#include "MovingLinkChannel.h"
+#include "../Satellite.h"
+#include "omnetpp/checkandcast.h"
+#include "omnetpp/cmodule.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+Define_Module(TopologyManager);
+
+void TopologyManager::initialize() {
+  // Nodes may query us before our own initialize() runs, so discovery and
+  // the first build are done lazily
+  discoverNodes();
+}
+
+void TopologyManager::handleMessage(cMessage *) {
+  throw cRuntimeError("TopologyManager does not process messages");
+}
+
+void TopologyManager::finish() {
+  recordScalar("TopologyRebuilds", rebuilds);
+  recordScalar("TopologyEpochs", graphs[current].epoch);
+  if (dynamicCrossPlane) {
+    recordScalar("CrossPlaneLinkConnects", crossPlaneConnects);
+    recordScalar("CrossPlaneLinkDisconnects", crossPlaneDisconnects);
+  }
+}
+
+void TopologyManager::discoverNodes() {
+  if (discovered)
+    return;
+  discovered = true;
+
+  ephemeris = check_and_cast<ConstellationEphemeris *>(
+      getParentModule()->getSubmodule("ephemeris"));
+  epochInterval = par("epochInterval").doubleValue();
+  costChangeThreshold = par("costChangeThreshold").doubleValue();
+  linkUpSignal = registerSignal("linkUp");
+  linkDownSignal = registerSignal("linkDown");
+  linkCostChangedSignal = registerSignal("linkCostChanged");
+
+  int numSatellites = ephemeris->getNumSatellites();
+  int numGroundStations = ephemeris->getNumGroundStations();
+  for (int i = 0; i < numSatellites; i++) {
+    cModule *sat = ephemeris->getSatellite(i);
+    nodeModules.push_back(sat);
+    maxISLRange.push_back(sat->par("maxISLRange").doubleValue());
+    satellitePlane.push_back(sat->par("plane").intValue());
+  }
+  for (int i = 0; i < numGroundStations; i++) {
+    cModule *gs = ephemeris->getGroundStation(i);
+    nodeModules.push_back(gs);
+    groundMaxRange.push_back(gs->par("maxRange").doubleValue());
+  }
+  predictedRange.resize(numSatellites);
+  listeners.resize(nodeModules.size());
+
+  cModule *network = getParentModule();
+  dynamicCrossPlane = strcmp(network->par("crossPlaneLinks").stringValue(), "dynamic") == 0;
+  if (dynamicCrossPlane) {
+    crossPlaneTerminals = par("crossPlaneTerminals").intValue();
+    numPlanes = network->par("numPlanes").intValue();
+    // Same rule as the static builder: two planes have a single boundary
+    seamLinks = numPlanes > 2 && network->par("walkerSeamLinks").boolValue();
+    islType = cChannelType::get("InterSatelliteLink");
+  }
+
+  // Node numbering and addresses never change; both buffers share them
+  for (ContactGraph &graph : graphs) {
+    graph.numSatellites = numSatellites;
+    graph.numNodes = nodeModules.size();
+    graph.nodeAddress.resize(graph.numNodes);
+    graph.nodeByAddress.assign(ephemeris->getMaxAddress() + 1, -1);
+    for (int v = 0; v < graph.numNodes; v++) {
+      graph.nodeAddress[v] = ephemeris->addressOf(nodeModules[v]);
+      graph.nodeByAddress[graph.nodeAddress[v]] = v;
+    }
+  }
+}
+
+int TopologyManager::nodeOf(const cModule *module) {
+  Enter_Method_Silent();
+  discoverNodes();
+  return findNode(module);
+}
+
+int TopologyManager::findNode(const cModule *module) const {
+  int satellite = ephemeris->indexOf(module);
+  if (satellite >= 0)
+    return satellite;
+  int groundStation = ephemeris->groundStationIndexOf(module);
+  return groundStation >= 0 ? graphs[current].numSatellites + groundStation : -1;
+}
+
+const ContactGraph *TopologyManager::getSnapshot() {
+  // Re-pairing creates channels and rewires gates, and the rebuild emits
+  // our signals: both must happen in our context whoever reads first
+  Enter_Method_Silent();
+  discoverNodes();
+  bool newEpoch = !built || simTime() >= builtAt + epochInterval;
+  if (newEpoch && dynamicCrossPlane)
+    repairCrossPlaneLinks();
+  if (newEpoch || dirty)
+    rebuild();
+  return &graphs[current];
+}
+
+cModule *TopologyManager::getNodeModule(int node) {
+  Enter_Method_Silent();
+  discoverNodes();
+  return nodeModules[node];
+}
+
+void TopologyManager::subscribe(int node, LinkStateListener *listener) {
+  Enter_Method_Silent();
+  discoverNodes();
+  listeners[node].push_back(listener);
+}
+
+void TopologyManager::unsubscribe(int node, LinkStateListener *listener) {
+  Enter_Method_Silent();
+  std::vector<LinkStateListener *> &list = listeners[node];
+  list.erase(std::remove(list.begin(), list.end(), listener), list.end());
+}
+
+void TopologyManager::setPredictedRange(int satellite, int gate, bool inRange) {
+  Enter_Method_Silent();
+  discoverNodes();
+  std::vector<int8_t> &gates = predictedRange[satellite];
+  if (gate >= (int)gates.size())
+    gates.resize(gate + 1, -1);
+  gates[gate] = inRange ? 1 : 0;
+  dirty = true;
+}
+
+void TopologyManager::clearPredictedRange(int satellite, int gate) {
+  std::vector<int8_t> &gates = predictedRange[satellite];
+  if (gate < (int)gates.size())
+    gates[gate] = -1;
+}
+
+void TopologyManager::rebuild() {
+  const ContactGraph &previous = graphs[current];
+  ContactGraph &graph = graphs[1 - current];
+
+  graph.time = simTime().dbl();
+  graph.offsets.resize(graph.numNodes + 1);
+  graph.target.clear();
+  graph.gate.clear();
+  graph.distance.clear();
+  graph.delay.clear();
+
+  for (int v = 0; v < graph.numNodes; v++) {
+    graph.offsets[v] = graph.target.size();
+    cModule *module = nodeModules[v];
+    bool satellite = graph.isSatellite(v);
+    const char *gateVector = satellite ? "radioOut" : "groundLink";
+    const char *outGateName = satellite ? "radioOut$o" : "groundLink$o";
+
+    int numGates = module->gateSize(gateVector);
+    for (int i = 0; i < numGates; i++) {
+      cGate *outGate = module->gate(outGateName, i);
+      if (!outGate->isConnected())
+        continue;
+      int peer = findNode(outGate->getPathEndGate()->getOwnerModule());
+      if (peer < 0)
+        continue;
+
+      double distance;
+      if (satellite && graph.isSatellite(peer)) {
+        distance = ephemeris->distanceBetween(v, peer);
+        const std::vector<int8_t> &predicted = predictedRange[v];
+        bool inRange = (i < (int)predicted.size() && predicted[i] >= 0)
+                           ? predicted[i] == 1
+                           : distance <= maxISLRange[v];
+        if (!inRange || !ephemeris->isLinkClear(ephemeris->registerLink(v, peer)))
+          continue;
+      } else {
+        // Ground link: usable while the satellite is within the station's
+        // maxRange (the station hands over after it leaves)
+        int satelliteNode = satellite ? v : peer;
+        int groundStation = (satellite ? peer : v) - graph.numSatellites;
+        distance = ephemeris->distanceTo(satelliteNode,
+            ephemeris->getGroundStationPosition(groundStation));
+        if (distance > groundMaxRange[groundStation])
+          continue;
+      }
+
+      MovingLinkChannel *channel =
+          dynamic_cast<MovingLinkChannel *>(outGate->getTransmissionChannel());
+      double processingDelay = channel ? channel->getProcessingDelay() : 0;
+
+      graph.target.push_back(peer);
+      graph.gate.push_back(i);
+      graph.distance.push_back(distance);
+      graph.delay.push_back(distance / SPEED_OF_LIGHT + processingDelay);
+    }
+  }
+  graph.offsets[graph.numNodes] = graph.target.size();
+
+  changes.clear();
+  publishedDistance[1 - current].resize(graph.numEdges());
+  for (int v = 0; v < graph.numNodes; v++)
+    diffNode(v, previous, graph);
+
+  // Same links as before (distances always move): keep the epoch
+  bool sameLinks = built && graph.offsets == previous.offsets &&
+                   graph.target == previous.target && graph.gate == previous.gate;
+  graph.epoch = sameLinks ? previous.epoch : previous.epoch + 1;
+
+  current = 1 - current;
+  built = true;
+  dirty = false;
+  builtAt = simTime();
+  rebuilds++;
+
+  publishChanges();
+}
+
+// Compare the out-links of 'node' in both snapshots. Rows are in gate
+// order, so one merge pass finds every change.
+void TopologyManager::diffNode(int node, const ContactGraph &previous,
+                               const ContactGraph &graph) {
+  const std::vector<double> &oldPublished = publishedDistance[current];
+  std::vector<double> &newPublished = publishedDistance[1 - current];
+
+  uint32_t o = built ? previous.edgesBegin(node) : 0;
+  uint32_t oldEnd = built ? previous.edgesEnd(node) : 0;
+  auto lost = [&](uint32_t k) {
+    changes.push_back({LinkChangeKind::Down, node, previous.target[k], previous.gate[k],
+                       oldPublished[k]});
+  };
+
+  for (uint32_t e = graph.edgesBegin(node); e < graph.edgesEnd(node); e++) {
+    while (o < oldEnd && previous.gate[o] < graph.gate[e])
+      lost(o++);
+
+    if (o < oldEnd && previous.gate[o] == graph.gate[e] &&
+        previous.target[o] == graph.target[e]) {
+      newPublished[e] = oldPublished[o];
+      if (std::fabs(graph.distance[e] - oldPublished[o]) > costChangeThreshold) {
+        newPublished[e] = graph.distance[e];
+        changes.push_back({LinkChangeKind::CostChanged, node, graph.target[e],
+                           graph.gate[e], graph.distance[e]});
+      }
+      o++;
+      continue;
+    }
+
+    // Gate rewired to another peer: down, then up
+    if (o < oldEnd && previous.gate[o] == graph.gate[e])
+      lost(o++);
+    newPublished[e] = graph.distance[e];
+    changes.push_back({LinkChangeKind::Up, node, graph.target[e], graph.gate[e],
+                       graph.distance[e]});
+  }
+  while (o < oldEnd)
+    lost(o++);
+}
+
+void TopologyManager::publishChanges() {
+  const ContactGraph &graph = graphs[current];
+  for (const LinkChange &change : changes) {
+    long address = graph.nodeAddress[change.from];
+    switch (change.kind) {
+    case LinkChangeKind::Up:
+      emit(linkUpSignal, address);
+      break;
+    case LinkChangeKind::Down:
+      emit(linkDownSignal, address);
+      break;
+    case LinkChangeKind::CostChanged:
+      emit(linkCostChangedSignal, address);
+      break;
+    }
+    // By index: a listener may subscribe others while being notified
+    const std::vector<LinkStateListener *> &list = listeners[change.from];
+    for (size_t k = 0; k < list.size(); k++)
+      list[k]->linkStateChanged(change);
+  }
+}
+
+// Re-pair the cross-plane ISLs for the current positions. Candidates are
+// satellites of the adjacent (east) plane within maxISLRange, found through
+// the spatial index and screened for Earth occlusion in one batch.
+void TopologyManager::repairCrossPlaneLinks() {
+  int numSatellites = graphs[current].numSatellites;
+
+  std::unordered_set<long long> existing;
+  for (const CrossPlaneLink &link : crossPlaneLinks)
+    existing.insert((long long)link.east * numSatellites + link.west);
+
+  candidates.clear();
+  candidateEast.clear();
+  candidateWest.clear();
+  for (int a = 0; a < numSatellites; a++) {
+    if (satellitePlane[a] < 0)
+      continue;
+    int eastPlane = satellitePlane[a] + 1;
+    if (eastPlane == numPlanes) {
+      if (!seamLinks)
+        continue;
+      eastPlane = 0;
+    }
+    ephemeris->satellitesWithin(ephemeris->getPosition(a), maxISLRange[a], nearby);
+    for (int b : nearby) {
+      if (satellitePlane[b] != eastPlane)
+        continue;
+      IslCandidate candidate;
+      candidate.east = a;
+      candidate.west = b;
+      candidate.distance = ephemeris->distanceBetween(a, b);
+      candidate.current = existing.count((long long)a * numSatellites + b) > 0;
+      candidates.push_back(candidate);
+      candidateEast.push_back(a);
+      candidateWest.push_back(b);
+    }
+  }
+
+  ephemeris->checkLineOfSight(candidateEast, candidateWest, candidateClear);
+  size_t visible = 0;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    if (candidateClear[i])
+      candidates[visible++] = candidates[i];
+  }
+  candidates.resize(visible);
+
+  matched.clear();
+  matchCrossPlaneLinks(candidates, numSatellites, crossPlaneTerminals, matched);
+
+  // Rewire only the difference: drop links that were not kept, then
+  // connect the new ones on the freed (or fresh) gates
+  std::unordered_set<long long> selected;
+  for (const IslCandidate &link : matched)
+    selected.insert((long long)link.east * numSatellites + link.west);
+
+  size_t kept = 0;
+  for (const CrossPlaneLink &link : crossPlaneLinks) {
+    if (selected.count((long long)link.east * numSatellites + link.west))
+      crossPlaneLinks[kept++] = link;
+    else
+      disconnectCrossPlaneLink(link);
+  }
+  crossPlaneLinks.resize(kept);
+
+  for (const IslCandidate &link : matched) {
+    if (!link.current)
+      connectCrossPlaneLink(link.east, link.west);
+  }
+}
+
+void TopologyManager::connectCrossPlaneLink(int east, int west) {
+  Satellite *a = check_and_cast<Satellite *>(nodeModules[east]);
+  Satellite *b = check_and_cast<Satellite *>(nodeModules[west]);
+
+  CrossPlaneLink link;
+  link.east = east;
+  link.west = west;
+  link.eastGate = a->acquireLinkGate();
+  link.westGate = b->acquireLinkGate();
+
+  cChannel *eastToWest = islType->create("channel");
+  a->gate("radioOut$o", link.eastGate)->connectTo(b->gate("radioIn$i", link.westGate), eastToWest);
+  eastToWest->callInitialize();
+
+  cChannel *westToEast = islType->create("channel");
+  b->gate("radioOut$o", link.westGate)->connectTo(a->gate("radioIn$i", link.eastGate), westToEast);
+  westToEast->callInitialize();
+
+  crossPlaneLinks.push_back(link);
+  crossPlaneConnects++;
+  dirty = true;
+}
+
+void TopologyManager::disconnectCrossPlaneLink(const CrossPlaneLink &link) {
+  Satellite *a = check_and_cast<Satellite *>(nodeModules[link.east]);
+  Satellite *b = check_and_cast<Satellite *>(nodeModules[link.west]);
+
+  a->gate("radioOut$o", link.eastGate)->disconnect();
+  b->gate("radioOut$o", link.westGate)->disconnect();
+  a->releaseLinkGate(link.eastGate);
+  b->releaseLinkGate(link.westGate);
+  // The next link on a recycled gate starts from the distance test
+  clearPredictedRange(link.east, link.eastGate);
+  clearPredictedRange(link.west, link.westGate);
+
+  crossPlaneDisconnects++;
+  dirty = true;
+}
@@ -0,0 +1,119 @@
+#ifndef __MY_LEO_TOPOLOGYMANAGER_H_
+#define __MY_LEO_TOPOLOGYMANAGER_H_
+
+#include "../utils/ContactGraph.h"
+#include "../utils/CrossPlaneMatcher.h"
+#include "ConstellationEphemeris.h"
+#include "LinkStateListener.h"
+#include <omnetpp.h>
+#include <vector>
+
+using namespace omnetpp;
+
+// Global view of the links of the network. The contact graph (every
+// connected link that is currently usable: ISLs within maxISLRange and not
+// occluded by the Earth, ground links within the station's maxRange) is
+// computed once
+// per epoch into a CSR snapshot that Satellites, GroundStations and
+// routing read through a const pointer.
+//
+// A snapshot is rebuilt lazily on the first read once epochInterval has
+// passed, or as soon as links were connected, disconnected or predicted
+// to change (invalidate()). The pointer stays valid until the next
+// rebuild; compare ContactGraph::epoch to skip work when no link changed.
+//
+// It is also the link-state bus: every rebuild is diffed against the
+// previous snapshot and only the deltas (link up, link down, cost changed
+// beyond costChangeThreshold) are delivered to the listeners of the nodes
+// concerned, and emitted as signals for statistics.
+//
+// With crossPlaneLinks = "dynamic" the manager also owns the cross-plane
+// ISLs: at every epoch it matches east/west terminals of adjacent planes
+// over the visible candidates from the spatial index and rewires only the
+// links that changed.
+class TopologyManager : public cSimpleModule {
+
+private:
+  ConstellationEphemeris *ephemeris = nullptr;
+  double epochInterval;
+  bool discovered = false;
+
+  std::vector<cModule *> nodeModules; // node -> module (ContactGraph order)
+  std::vector<double> maxISLRange;    // per satellite (km)
+  std::vector<double> groundMaxRange; // per ground station (km)
+  // Predicted ISL range state per satellite and gate: -1 = use the
+  // distance test, 0 = out of range, 1 = in range
+  std::vector<std::vector<int8_t>> predictedRange;
+
+  // Double buffer: the snapshot being read and the one rebuilt next
+  ContactGraph graphs[2];
+  // Per edge of graphs[i]: distance last published to listeners
+  std::vector<double> publishedDistance[2];
+  int current = 0;
+  bool built = false;
+  bool dirty = true;
+  simtime_t builtAt;
+
+  // Dynamic cross-plane ISLs
+  struct CrossPlaneLink {
+    int east, west;         // satellites
+    int eastGate, westGate; // radioOut/radioIn index on each side
+  };
+  bool dynamicCrossPlane = false;
+  int crossPlaneTerminals;
+  int numPlanes;
+  bool seamLinks;
+  cChannelType *islType = nullptr;
+  std::vector<int> satellitePlane; // -1 = not part of the Walker shell
+  std::vector<CrossPlaneLink> crossPlaneLinks;
+  std::vector<IslCandidate> candidates, matched;
+  std::vector<int> candidateEast, candidateWest, nearby;
+  std::vector<uint8_t> candidateClear;
+
+  // Link-state bus
+  double costChangeThreshold; // km
+  std::vector<std::vector<LinkStateListener *>> listeners; // per node
+  std::vector<LinkChange> changes;
+  simsignal_t linkUpSignal;
+  simsignal_t linkDownSignal;
+  simsignal_t linkCostChangedSignal;
+
+  long rebuilds = 0;
+  long crossPlaneConnects = 0;
+  long crossPlaneDisconnects = 0;
+
+  void discoverNodes();
+  int findNode(const cModule *module) const;
+  void rebuild();
+  void diffNode(int node, const ContactGraph &previous, const ContactGraph &graph);
+  void publishChanges();
+  void repairCrossPlaneLinks();
+  void connectCrossPlaneLink(int east, int west);
+  void disconnectCrossPlaneLink(const CrossPlaneLink &link);
+  void clearPredictedRange(int satellite, int gate);
+
+protected:
+  virtual void initialize() override;
+  virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
+
+public:
+  // Current snapshot, rebuilt first if it is outdated
+  const ContactGraph *getSnapshot();
+  long getEpoch() { return getSnapshot()->epoch; }
+  cModule *getNodeModule(int node);
+  // ContactGraph node of a satellite or ground station, -1 if neither
+  int nodeOf(const cModule *module);
+
+  // Links were connected or disconnected: rebuild on the next read
+  void invalidate() { dirty = true; }
+
+  // Deliver the changes of 'node''s out-links to 'listener'
+  void subscribe(int node, LinkStateListener *listener);
+  void unsubscribe(int node, LinkStateListener *listener);
+  // Range state of a satellite's ISL from the link predictor, replacing
+  // the distance test for that gate
+  void setPredictedRange(int satellite, int gate, bool inRange);
+};
+
+#endif
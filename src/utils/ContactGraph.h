@@ -0,0 +1,38 @@
+#ifndef __MY_LEO_CONTACTGRAPH_H
+#define __MY_LEO_CONTACTGRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Snapshot of all usable links of the network at one instant, as a
+// directed graph in CSR form. Nodes are numbered satellites first (node ==
+// ephemeris slot), then ground stations (node == numSatellites + ground
+// station index). The out-edges of node v are [offsets[v], offsets[v + 1]);
+// every link appears once in each direction.
+struct ContactGraph {
+  long epoch = 0;   // changes whenever the set of links changes
+  double time = 0;  // simulation time the distances refer to (s)
+
+  int numSatellites = 0;
+  int numNodes = 0;
+  std::vector<int> nodeAddress;    // satelliteId or ground station address
+  std::vector<int> nodeByAddress;  // dense address -> node, -1 if unused
+
+  std::vector<uint32_t> offsets;   // numNodes + 1 entries
+  std::vector<int> target;         // peer node
+  std::vector<int> gate;           // output gate index at the source node
+  std::vector<double> distance;    // km
+  std::vector<double> delay;       // propagation + processing (s)
+
+  bool isSatellite(int node) const { return node < numSatellites; }
+  uint32_t edgesBegin(int node) const { return offsets[node]; }
+  uint32_t edgesEnd(int node) const { return offsets[node + 1]; }
+  size_t numEdges() const { return target.size(); }
+
+  int nodeOf(int address) const {
+    return address >= 0 && address < (int)nodeByAddress.size() ? nodeByAddress[address] : -1;
+  }
+};
+
+#endif
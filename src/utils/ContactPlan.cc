@@ -0,0 +1,75 @@
+#include "ContactPlan.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+void ContactPlan::build(int nodes, int satellites, std::vector<Contact> list) {
+    numNodes = nodes;
+    numSatellites = satellites;
+    contacts = std::move(list);
+    std::sort(contacts.begin(), contacts.end(), [](const Contact &a, const Contact &b) {
+        if (a.from != b.from)
+            return a.from < b.from;
+        return a.end != b.end ? a.end < b.end : a.to < b.to;
+    });
+
+    offsets.assign(numNodes + 1, 0);
+    for (const Contact &c : contacts)
+        offsets[c.from + 1]++;
+    for (int v = 0; v < numNodes; v++)
+        offsets[v + 1] += offsets[v];
+
+    changeTimes.clear();
+    for (const Contact &c : contacts) {
+        changeTimes.push_back(c.start);
+        changeTimes.push_back(c.end);
+    }
+    std::sort(changeTimes.begin(), changeTimes.end());
+    changeTimes.erase(std::unique(changeTimes.begin(), changeTimes.end()), changeTimes.end());
+}
+
+double ContactPlan::nextChangeAfter(double t) const {
+    auto it = std::upper_bound(changeTimes.begin(), changeTimes.end(), t);
+    return it != changeTimes.end() ? *it : std::numeric_limits<double>::infinity();
+}
+
+void ContactPlan::earliestArrival(int source, double time, ContactRoutes &routes,
+                                  std::vector<std::pair<double, int>> &heap) const {
+    const double infinity = std::numeric_limits<double>::infinity();
+    routes.source = source;
+    routes.time = time;
+    routes.validUntil = nextChangeAfter(time);
+    routes.arrival.assign(numNodes, infinity);
+    routes.firstHop.assign(numNodes, -1);
+    routes.departure.assign(numNodes, infinity);
+
+    // Min-heap with lazy deletion: stale entries are skipped when popped
+    auto later = std::greater<std::pair<double, int>>();
+    heap.clear();
+    routes.arrival[source] = time;
+    heap.emplace_back(time, source);
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        double t = heap.back().first;
+        int v = heap.back().second;
+        heap.pop_back();
+        if (t > routes.arrival[v] || (v != source && v >= numSatellites))
+            continue;
+
+        auto first = std::upper_bound(contacts.begin() + offsets[v], contacts.begin() + offsets[v + 1],
+                                      t, [](double value, const Contact &c) { return value < c.end; });
+        for (auto c = first; c != contacts.begin() + offsets[v + 1]; ++c) {
+            double depart = std::max(t, c->start);
+            double arrive = depart + c->delay;
+            int w = c->to;
+            if (arrive < routes.arrival[w]) {
+                routes.arrival[w] = arrive;
+                routes.firstHop[w] = v == source ? w : routes.firstHop[v];
+                routes.departure[w] = v == source ? depart : routes.departure[v];
+                heap.emplace_back(arrive, w);
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+    }
+}
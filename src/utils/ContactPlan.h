@@ -0,0 +1,61 @@
+#ifndef __MY_LEO_CONTACTPLAN_H
+#define __MY_LEO_CONTACTPLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// One predicted contact: the directed link from -> to is usable during
+// [start, end). Nodes use the ContactGraph numbering (satellites first,
+// then ground stations).
+struct Contact {
+    int from, to;
+    double start, end;  // s
+    double delay;       // one-way delay at the longest range of the window (s)
+};
+
+// Earliest-arrival routes from one source, for departures at 'time'
+struct ContactRoutes {
+    int source = -1;
+    double time = 0;
+    double validUntil = -1;          // next start or end of any contact
+    std::vector<double> arrival;     // infinity if unreachable
+    std::vector<int> firstHop;       // neighbour of the source, -1 if none
+    std::vector<double> departure;   // when the first contact is taken
+};
+
+// Time-varying topology of a whole run (contact plan) and the Contact
+// Graph Routing search over it. A route is the sequence of contacts with
+// the earliest arrival at the destination, waiting at a node for a
+// contact that has not started yet (store and forward); ground stations
+// are endpoints only, never transit hops.
+//
+// The search is a Dijkstra on arrival times: a contact from v is taken at
+// max(arrival(v), start) if that is before its end. Contacts are stored
+// per source node sorted by end, so contacts that are already over are
+// skipped with one binary search.
+class ContactPlan {
+
+public:
+    void build(int numNodes, int numSatellites, std::vector<Contact> contacts);
+
+    size_t size() const { return contacts.size(); }
+    const std::vector<Contact> &getContacts() const { return contacts; }
+
+    // First contact start or end strictly after 't' (routes computed at
+    // 't' stay valid until then), infinity if none
+    double nextChangeAfter(double t) const;
+
+    void earliestArrival(int source, double time, ContactRoutes &routes,
+                         std::vector<std::pair<double, int>> &heap) const;
+
+private:
+    int numNodes = 0;
+    int numSatellites = 0;
+    std::vector<uint32_t> offsets;    // CSR by 'from', numNodes + 1 entries
+    std::vector<Contact> contacts;    // by 'from', then by end
+    std::vector<double> changeTimes;  // sorted, unique
+};
+
+#endif
@@ -0,0 +1,23 @@
+#include "CrossPlaneMatcher.h"
+#include <algorithm>
+
+void matchCrossPlaneLinks(std::vector<IslCandidate> &candidates, int numSatellites,
+                          int terminals, std::vector<IslCandidate> &result) {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const IslCandidate &a, const IslCandidate &b) {
+                  if (a.current != b.current)
+                      return a.current;
+                  if (a.distance != b.distance)
+                      return a.distance < b.distance;
+                  return a.east != b.east ? a.east < b.east : a.west < b.west;
+              });
+
+    std::vector<int> eastUsed(numSatellites, 0), westUsed(numSatellites, 0);
+    for (const IslCandidate &candidate : candidates) {
+        if (eastUsed[candidate.east] >= terminals || westUsed[candidate.west] >= terminals)
+            continue;
+        eastUsed[candidate.east]++;
+        westUsed[candidate.west]++;
+        result.push_back(candidate);
+    }
+}
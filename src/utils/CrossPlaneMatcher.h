@@ -0,0 +1,27 @@
+#ifndef __MY_LEO_CROSSPLANEMATCHER_H
+#define __MY_LEO_CROSSPLANEMATCHER_H
+
+#include <vector>
+
+// Pairing of cross-plane ISLs between adjacent orbital planes. Every
+// satellite has 'terminals' laser terminals facing east (next plane) and as
+// many facing west (previous plane); a link joins an east terminal of one
+// satellite to a west terminal of a satellite in the next plane, so the
+// candidates form a bipartite graph east x west.
+//
+// Greedy matching: existing links that are still feasible are kept first
+// (no needless re-pointing of terminals), then the shortest remaining
+// candidates are taken while both ends have a free terminal. O(E log E)
+// for E candidates, and the result is maximal.
+struct IslCandidate {
+  int east;        // satellite using an east terminal
+  int west;        // satellite using a west terminal
+  double distance; // km
+  bool current;    // this link exists right now
+};
+
+// Selected links, appended to 'result'. Reorders 'candidates'.
+void matchCrossPlaneLinks(std::vector<IslCandidate> &candidates, int numSatellites,
+                          int terminals, std::vector<IslCandidate> &result);
+
+#endif
@@ -0,0 +1,250 @@
+#include "EphemerisTable.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MY_LEO_HAVE_MMAP 1
+#else
+#include <process.h>
+#endif
+
+static const char EPHEMERIS_MAGIC[8] = {'L', 'E', 'O', 'E', 'P', 'H', '0', '1'};
+static const uint32_t EPHEMERIS_VERSION = 1;
+static const int RECORD_DOUBLES = 6; // x, y, z, vx, vy, vz
+
+static_assert(sizeof(EphemerisTable::Header) == 64, "ephemeris header must stay 64 bytes");
+
+EphemerisTable::~EphemerisTable() { close(); }
+
+uint64_t EphemerisTable::hashOrbits(const std::vector<OrbitState> &orbits,
+                                    const std::vector<Sgp4Record> &elementSets) {
+    // FNV-1a over the time-independent elements
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](double value) {
+        unsigned char bytes[sizeof(double)];
+        memcpy(bytes, &value, sizeof(double));
+        for (unsigned char b : bytes) {
+            hash ^= b;
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (const OrbitState &state : orbits) {
+        mix(state.semiMajorAxis);
+        mix(state.eccentricity);
+        mix(state.meanAnomaly0);
+        mix(state.meanMotion);
+        mix(state.raanRate);
+        mix(state.argPerigeeRate);
+        for (int k = 0; k < 3; k++) {
+            mix(state.P[k]);
+            mix(state.Q[k]);
+        }
+    }
+    for (const Sgp4Record &record : elementSets) {
+        mix(record.inclo);
+        mix(record.nodeo);
+        mix(record.ecco);
+        mix(record.argpo);
+        mix(record.mo);
+        mix(record.noKozai);
+        mix(record.bstar);
+        mix(record.tsince0);
+    }
+    return hash;
+}
+
+bool EphemerisTable::generate(const std::string &path, const std::vector<OrbitState> &orbits,
+                              double duration, double step) {
+    return generate(path, orbits.size(), hashOrbits(orbits), duration, step,
+                    [&orbits](size_t i, double t, Position3D &pos, Position3D &vel) {
+                        calculateSatelliteStateECEF(orbits[i], t, pos, vel);
+                        return true;
+                    });
+}
+
+bool EphemerisTable::generate(const std::string &path, size_t numSatellites, uint64_t orbitHash,
+                              double duration, double step, const StateFunction &state) {
+    if (step <= 0 || duration < 0)
+        return false;
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, EPHEMERIS_MAGIC, sizeof(h.magic));
+    h.version = EPHEMERIS_VERSION;
+    h.numSatellites = numSatellites;
+    h.numSamples = (uint64_t)ceil(duration / step) + 1;
+    h.orbitHash = orbitHash;
+    h.startTime = 0;
+    h.step = step;
+
+    // Unique per writer: runs of a sweep that miss the cache together must
+    // not truncate each other's output
+#ifdef MY_LEO_HAVE_MMAP
+    std::string tmpPath = path + ".XXXXXX";
+    int fd = mkstemp(&tmpPath[0]);
+    if (fd < 0)
+        return false;
+    fchmod(fd, 0644);
+    FILE *f = fdopen(fd, "wb");
+    if (!f) {
+        ::close(fd);
+        remove(tmpPath.c_str());
+        return false;
+    }
+#else
+    std::string tmpPath = path + ".tmp." + std::to_string(_getpid());
+    FILE *f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+        return false;
+#endif
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    std::vector<double> block(numSatellites * RECORD_DOUBLES);
+    for (uint64_t k = 0; ok && k < h.numSamples; k++) {
+        double t = h.startTime + k * step;
+        for (size_t i = 0; ok && i < numSatellites; i++) {
+            Position3D pos, vel;
+            ok = state(i, t, pos, vel);
+            double *rec = &block[i * RECORD_DOUBLES];
+            rec[0] = pos.x;
+            rec[1] = pos.y;
+            rec[2] = pos.z;
+            rec[3] = vel.x;
+            rec[4] = vel.y;
+            rec[5] = vel.z;
+        }
+        ok = ok && fwrite(block.data(), sizeof(double), block.size(), f) == block.size();
+    }
+
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool EphemerisTable::open(const std::string &path) {
+    close();
+
+#ifdef MY_LEO_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping stays valid
+    if (mapped == MAP_FAILED)
+        return false;
+    data = mapped;
+    dataSize = st.st_size;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return false;
+    buffer.resize((size_t)in.tellg());
+    in.seekg(0);
+    if (buffer.size() < sizeof(Header) || !in.read(buffer.data(), buffer.size())) {
+        buffer.clear();
+        return false;
+    }
+    data = buffer.data();
+    dataSize = buffer.size();
+#endif
+
+    header = static_cast<const Header *>(data);
+    records = reinterpret_cast<const double *>(static_cast<const char *>(data) + sizeof(Header));
+
+    size_t expected = sizeof(Header) + header->numSamples * header->numSatellites *
+                                           RECORD_DOUBLES * sizeof(double);
+    if (memcmp(header->magic, EPHEMERIS_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != EPHEMERIS_VERSION || header->numSamples < 2 ||
+        header->step <= 0 || dataSize != expected) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void EphemerisTable::close() {
+#ifdef MY_LEO_HAVE_MMAP
+    if (data)
+        munmap(data, dataSize);
+#endif
+    buffer.clear();
+    data = nullptr;
+    dataSize = 0;
+    header = nullptr;
+    records = nullptr;
+}
+
+double EphemerisTable::getEndTime() const {
+    return header->startTime + (header->numSamples - 1) * header->step;
+}
+
+bool EphemerisTable::covers(double time) const {
+    return isOpen() && time >= header->startTime && time <= getEndTime();
+}
+
+void EphemerisTable::locate(double time, size_t &sample, double &s) const {
+    double u = (time - header->startTime) / header->step;
+    sample = (size_t)u;
+    if (sample >= header->numSamples - 1)
+        sample = header->numSamples - 2;
+    s = u - sample;
+}
+
+// Cubic Hermite on one axis: p0/v0 at s=0, p1/v1 at s=1, velocities scaled by h
+static inline double hermite(double p0, double v0, double p1, double v1, double h, double s) {
+    double s2 = s * s;
+    double s3 = s2 * s;
+    return (2 * s3 - 3 * s2 + 1) * p0 + (s3 - 2 * s2 + s) * h * v0 +
+           (-2 * s3 + 3 * s2) * p1 + (s3 - s2) * h * v1;
+}
+
+Position3D EphemerisTable::lookup(int satellite, double time) const {
+    size_t k;
+    double s;
+    locate(time, k, s);
+
+    size_t n = header->numSatellites;
+    const double *a = records + (k * n + satellite) * RECORD_DOUBLES;
+    const double *b = a + n * RECORD_DOUBLES;
+    double h = header->step;
+
+    Position3D pos;
+    pos.x = hermite(a[0], a[3], b[0], b[3], h, s);
+    pos.y = hermite(a[1], a[4], b[1], b[4], h, s);
+    pos.z = hermite(a[2], a[5], b[2], b[5], h, s);
+    return pos;
+}
+
+void EphemerisTable::lookupAll(double time, PositionSoA &out) const {
+    size_t k;
+    double s;
+    locate(time, k, s);
+
+    size_t n = header->numSatellites;
+    out.resize(n);
+    const double *blockA = records + k * n * RECORD_DOUBLES;
+    const double *blockB = blockA + n * RECORD_DOUBLES;
+    double h = header->step;
+
+    for (size_t i = 0; i < n; i++) {
+        const double *a = blockA + i * RECORD_DOUBLES;
+        const double *b = blockB + i * RECORD_DOUBLES;
+        out.x[i] = hermite(a[0], a[3], b[0], b[3], h, s);
+        out.y[i] = hermite(a[1], a[4], b[1], b[4], h, s);
+        out.z[i] = hermite(a[2], a[5], b[2], b[5], h, s);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef __MY_LEO_EPHEMERISTABLE_H
+#define __MY_LEO_EPHEMERISTABLE_H
+
+#include "PositionUtils.h"
+#include "Sgp4.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Precomputed constellation ephemeris stored in a binary file and mapped
+// read-only into memory, so parameter sweeps share one table instead of
+// propagating identical orbits in every run.
+//
+// File layout (native endianness):
+//   Header (64 bytes), then numSamples blocks of numSatellites records.
+//   Record = ECEF position (km) + ECEF velocity (km/s), 6 doubles.
+// Sample k holds the state at startTime + k * step. Positions in between are
+// cubic Hermite interpolated from the two surrounding samples.
+class EphemerisTable {
+
+public:
+  struct Header {
+    char magic[8];          // "LEOEPH01"
+    uint32_t version;
+    uint32_t numSatellites;
+    uint64_t numSamples;
+    uint64_t orbitHash;     // hashOrbits() of the generating constellation
+    double startTime;       // s
+    double step;            // s
+    uint8_t reserved[16];
+  };
+
+  EphemerisTable() {}
+  ~EphemerisTable();
+
+  EphemerisTable(const EphemerisTable &) = delete;
+  EphemerisTable &operator=(const EphemerisTable &) = delete;
+
+  // Propagate 'orbits' over [0, duration] every 'step' seconds and write the
+  // table to 'path'. The file is written under a temporary name unique to
+  // this writer and renamed, so concurrent runs never see a partial table.
+  // Returns false on I/O error.
+  static bool generate(const std::string &path, const std::vector<OrbitState> &orbits,
+                       double duration, double step);
+
+  // Same for any propagator: 'state' gives the ECEF position and velocity
+  // of a satellite at a time, or false if it cannot (generation fails)
+  typedef std::function<bool(size_t satellite, double time, Position3D &pos,
+                             Position3D &vel)> StateFunction;
+  static bool generate(const std::string &path, size_t numSatellites, uint64_t orbitHash,
+                       double duration, double step, const StateFunction &state);
+
+  // Fingerprint of a constellation, used to detect stale tables. SGP4
+  // element sets are folded in after the analytic orbits.
+  static uint64_t hashOrbits(const std::vector<OrbitState> &orbits,
+                             const std::vector<Sgp4Record> &elementSets = {});
+
+  // Map an existing table. Returns false if missing or malformed.
+  bool open(const std::string &path);
+  void close();
+
+  bool isOpen() const { return data != nullptr; }
+  const Header &getHeader() const { return *header; }
+  double getEndTime() const;
+  bool covers(double time) const;
+
+  // Interpolated ECEF position of one satellite / of all satellites
+  Position3D lookup(int satellite, double time) const;
+  void lookupAll(double time, PositionSoA &out) const;
+
+private:
+  const Header *header = nullptr;
+  const double *records = nullptr;
+  void *data = nullptr;
+  size_t dataSize = 0;
+  std::vector<char> buffer; // used instead of mmap where it is unavailable
+
+  void locate(double time, size_t &sample, double &s) const;
+};
+
+#endif
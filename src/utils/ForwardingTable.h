@@ -0,0 +1,58 @@
+#ifndef __MY_LEO_FORWARDINGTABLE_H
+#define __MY_LEO_FORWARDINGTABLE_H
+
+#include <cstddef>
+#include <vector>
+
+// Forwarding information base of one node: a dense array indexed by
+// destination node id (satelliteId or ground station address, see
+// ConstellationEphemeris::getMaxAddress()), so the per-packet lookup is a
+// single load. An entry holds the output gate to send on directly; gate
+// -1 means no route.
+class ForwardingTable {
+
+public:
+    struct Entry {
+        int gate = -1;     // output gate index at this node
+        int nextHop = -1;  // node id of the neighbour behind 'gate'
+        double cost = 0;   // km
+    };
+
+    // Size for node ids 0..maxNodeId, no routes
+    void reset(int maxNodeId) {
+        entries.assign(maxNodeId + 1, Entry());
+        routes = 0;
+    }
+    void clear() { reset((int)entries.size() - 1); }
+
+    // Route to 'destination', nullptr if there is none
+    const Entry *lookup(int destination) const {
+        if ((unsigned)destination >= entries.size() || entries[destination].gate < 0)
+            return nullptr;
+        return &entries[destination];
+    }
+
+    void set(int destination, int gate, int nextHop, double cost) {
+        Entry &e = entries[destination];
+        routes += e.gate < 0;
+        e.gate = gate;
+        e.nextHop = nextHop;
+        e.cost = cost;
+    }
+    void remove(int destination) {
+        Entry &e = entries[destination];
+        routes -= e.gate >= 0;
+        e = Entry();
+    }
+
+    // Number of destinations with a route
+    size_t size() const { return routes; }
+    // Node ids are 0..capacity() - 1
+    int capacity() const { return (int)entries.size(); }
+
+private:
+    std::vector<Entry> entries;
+    size_t routes = 0;
+};
+
+#endif
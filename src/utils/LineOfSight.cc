@@ -0,0 +1,78 @@
+#include "LineOfSight.h"
+
+namespace {
+
+__attribute__((always_inline)) inline bool clearOfSphere(double ax, double ay, double az,
+                                                         double bx, double by, double bz,
+                                                         double radius2) {
+    double dx = bx - ax, dy = by - ay, dz = bz - az;
+    double aa = ax * ax + ay * ay + az * az;
+    double bb = bx * bx + by * by + bz * bz;
+    double dd = dx * dx + dy * dy + dz * dz;
+    double ad = ax * dx + ay * dy + az * dz;
+    // Closest point strictly inside the segment (0 < t < 1): its squared
+    // distance is aa - ad^2 / dd, compared without dividing. Bitwise
+    // operators keep the loop free of branches.
+    bool interior = (ad < 0) & (-ad < dd);
+    bool endsClear = (aa > radius2) & (bb > radius2);
+    bool interiorClear = (aa - radius2) * dd > ad * ad;
+    return endsClear & (!interior | interiorClear);
+}
+
+__attribute__((always_inline)) inline void clearRange(const SegmentSoA &segments, double radius2,
+                                                      uint8_t *__restrict clear, size_t n) {
+    const double *__restrict ax = segments.ax.data();
+    const double *__restrict ay = segments.ay.data();
+    const double *__restrict az = segments.az.data();
+    const double *__restrict bx = segments.bx.data();
+    const double *__restrict by = segments.by.data();
+    const double *__restrict bz = segments.bz.data();
+
+    for (size_t i = 0; i < n; i++)
+        clear[i] = clearOfSphere(ax[i], ay[i], az[i], bx[i], by[i], bz[i], radius2);
+}
+
+typedef void (*ClearKernel)(const SegmentSoA &, double, uint8_t *, size_t);
+
+void clearScalar(const SegmentSoA &segments, double radius2, uint8_t *clear, size_t n) {
+    clearRange(segments, radius2, clear, n);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MY_LEO_HAVE_X86_KERNELS 1
+
+__attribute__((target("avx2,fma")))
+void clearAVX2(const SegmentSoA &segments, double radius2, uint8_t *clear, size_t n) {
+    clearRange(segments, radius2, clear, n);
+}
+
+__attribute__((target("avx512f,avx512dq,avx512bw,avx2,fma")))
+void clearAVX512(const SegmentSoA &segments, double radius2, uint8_t *clear, size_t n) {
+    clearRange(segments, radius2, clear, n);
+}
+#endif
+
+ClearKernel selectKernel() {
+#ifdef MY_LEO_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512bw"))
+        return clearAVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return clearAVX2;
+#endif
+    return clearScalar;
+}
+
+} // namespace
+
+bool segmentClearOfSphere(const Position3D &a, const Position3D &b, double radius) {
+    return clearOfSphere(a.x, a.y, a.z, b.x, b.y, b.z, radius * radius);
+}
+
+void segmentsClearOfSphere(const SegmentSoA &segments, double radius,
+                           std::vector<uint8_t> &clear) {
+    static const ClearKernel kernel = selectKernel();
+    clear.resize(segments.size());
+    kernel(segments, radius * radius, clear.data(), segments.size());
+}
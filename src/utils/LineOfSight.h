@@ -0,0 +1,37 @@
+#ifndef __MY_LEO_LINEOFSIGHT_H
+#define __MY_LEO_LINEOFSIGHT_H
+
+#include "PositionUtils.h"
+#include <cstdint>
+#include <vector>
+
+// Earth occlusion of straight links. A segment a-b is clear if no point of
+// it comes closer to the Earth's centre than 'radius' (km), i.e. Earth
+// radius plus the grazing altitude below which the beam is considered
+// blocked by the Earth or the dense atmosphere.
+//
+// Both endpoints must be above 'radius'; if the point closest to the
+// origin lies inside the segment (d = b - a, 0 < -(a . d) < d . d), also
+// |a|^2 - (a . d)^2 / (d . d) > radius^2. Evaluated without branches or
+// divisions, so the batch version runs several segments per SIMD register.
+
+// Endpoints of many segments, stored column-wise (ECEF, km)
+struct SegmentSoA {
+  std::vector<double> ax, ay, az;
+  std::vector<double> bx, by, bz;
+
+  void resize(size_t n) {
+    ax.resize(n); ay.resize(n); az.resize(n);
+    bx.resize(n); by.resize(n); bz.resize(n);
+  }
+  size_t size() const { return ax.size(); }
+};
+
+bool segmentClearOfSphere(const Position3D &a, const Position3D &b, double radius);
+
+// clear[i] = 1 if segment i is clear, 0 if occluded. Uses the widest SIMD
+// kernel the CPU supports, like propagateBatch().
+void segmentsClearOfSphere(const SegmentSoA &segments, double radius,
+                           std::vector<uint8_t> &clear);
+
+#endif
@@ -0,0 +1,93 @@
+#include "LinkPredictor.h"
+#include <algorithm>
+
+namespace {
+
+struct RangeSample {
+    double f;  // |dr|^2 - range^2
+    double df; // d/dt of the above
+};
+
+// Scan [t0, t0 + horizon] for the first time at which the range state is no
+// longer 'inRange'. 'sample' returns f and f' at a given time.
+template <typename Sampler>
+LinkPrediction findCrossing(Sampler sample, double t0, bool inRange,
+                            double horizon, double step) {
+    auto changed = [inRange](double f) { return inRange ? f > 0 : f <= 0; };
+
+    double tEnd = t0 + horizon;
+    double ta = t0;
+    RangeSample sa = sample(ta);
+
+    while (ta < tEnd) {
+        double tb = std::min(ta + step, tEnd);
+        RangeSample sb = sample(tb);
+
+        double hi = -1;
+        if (changed(sb.f)) {
+            hi = tb;
+        } else if ((inRange && sa.df > 0 && sb.df <= 0) || (!inRange && sa.df < 0 && sb.df >= 0)) {
+            // f has an extremum inside the step that may cross the range and
+            // come back before tb (short grazing passes): find it on f'
+            double lo = ta, up = tb;
+            while (up - lo > LINK_PREDICTION_TOLERANCE) {
+                double mid = 0.5 * (lo + up);
+                if ((sample(mid).df > 0) == (sa.df > 0))
+                    lo = mid;
+                else
+                    up = mid;
+            }
+            if (changed(sample(up).f))
+                hi = up;
+        }
+
+        if (hi >= 0) {
+            // Bisection on f: unchanged at 'lo', changed at 'hi'
+            double lo = ta;
+            while (hi - lo > LINK_PREDICTION_TOLERANCE) {
+                double mid = 0.5 * (lo + hi);
+                if (changed(sample(mid).f))
+                    hi = mid;
+                else
+                    lo = mid;
+            }
+            return {true, hi};
+        }
+
+        ta = tb;
+        sa = sb;
+    }
+    return {false, tEnd};
+}
+
+} // namespace
+
+LinkPrediction predictRangeCrossing(const OrbitState &a, const OrbitState &b,
+                                    double range, double t0, bool inRange,
+                                    double horizon, double step) {
+    double range2 = range * range;
+    auto sample = [&](double t) {
+        Position3D pa, va, pb, vb;
+        calculateSatelliteStateECEF(a, t, pa, va);
+        calculateSatelliteStateECEF(b, t, pb, vb);
+        double dx = pa.x - pb.x, dy = pa.y - pb.y, dz = pa.z - pb.z;
+        double dvx = va.x - vb.x, dvy = va.y - vb.y, dvz = va.z - vb.z;
+        return RangeSample{dx * dx + dy * dy + dz * dz - range2,
+                           2 * (dx * dvx + dy * dvy + dz * dvz)};
+    };
+    return findCrossing(sample, t0, inRange, horizon, step);
+}
+
+LinkPrediction predictRangeCrossing(const OrbitState &a, const Position3D &point,
+                                    double range, double t0, bool inRange,
+                                    double horizon, double step) {
+    double range2 = range * range;
+    auto sample = [&](double t) {
+        Position3D pa, va;
+        calculateSatelliteStateECEF(a, t, pa, va);
+        double dx = pa.x - point.x, dy = pa.y - point.y, dz = pa.z - point.z;
+        return RangeSample{dx * dx + dy * dy + dz * dz - range2,
+                           2 * (dx * va.x + dy * va.y + dz * va.z)};
+    };
+    return findCrossing(sample, t0, inRange, horizon, step);
+}
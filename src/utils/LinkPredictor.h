@@ -0,0 +1,32 @@
+#ifndef __MY_LEO_LINKPREDICTOR_H
+#define __MY_LEO_LINKPREDICTOR_H
+
+#include "PositionUtils.h"
+
+// Predicts when a link's range condition |r_a(t) - r_b(t)| <= range changes,
+// from the analytic orbits instead of polling positions.
+//
+// f(t) = |r_a - r_b|^2 - range^2 is sampled every 'step' seconds together
+// with its derivative 2 (r_a - r_b).(v_a - v_b). A crossing is bracketed by
+// a sign change of f, or by an extremum of f (sign change of f') that dips
+// across the range between two samples, and refined by bisection to
+// LINK_PREDICTION_TOLERANCE. 'step' must be short compared to the time a
+// link stays up or down (a few seconds to tens of seconds for LEO).
+struct LinkPrediction {
+  bool found;   // false: no change within the horizon
+  double time;  // first time the state differs from 'inRange' (s)
+};
+
+const double LINK_PREDICTION_TOLERANCE = 1e-6; // s
+
+// Satellite <-> satellite (ISL)
+LinkPrediction predictRangeCrossing(const OrbitState &a, const OrbitState &b,
+                                    double range, double t0, bool inRange,
+                                    double horizon, double step);
+
+// Satellite <-> fixed ECEF point (ground station)
+LinkPrediction predictRangeCrossing(const OrbitState &a, const Position3D &point,
+                                    double range, double t0, bool inRange,
+                                    double horizon, double step);
+
+#endif
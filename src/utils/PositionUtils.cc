@@ -60,48 +60,87 @@ double solveKepler(double M, double e) {
     return E;
 }
 
-Position3D calculateSatellitePositionECEF(const OrbitParams &params, double time) {
-    // 1. Mean Motion (n) calculation
+OrbitState makeOrbitState(const OrbitParams &params, PerturbationModel model) {
+    OrbitState state;
     double a = params.semiMajorAxis; // km
-    double n = sqrt(EARTH_GRAVITATIONAL_MU / (a * a * a)); // rad/s
+    double e = params.eccentricity;
+
+    state.semiMajorAxis = a;
+    state.eccentricity = e;
+    state.kind = orbitKindOf(params);
+    state.model = model;
+
+    // Mean Motion (n)
+    state.meanMotion = sqrt(EARTH_GRAVITATIONAL_MU / (a * a * a)); // rad/s
 
-    // 2. Mean Anomaly (M) at time t
-    // M(t) = M0 + n*t. 
-    // We assume initial True Anomaly is given, need to convert to M0 first?
+    // M(t) = M0 + n*t.
     // For simplicity, let's assume params.trueAnomaly is Mean Anomaly at t=0
-    double M_0 = deg2rad(params.trueAnomaly);
-    double M = M_0 + n * time;
+    state.meanAnomaly0 = deg2rad(params.trueAnomaly);
+    state.sqrtOneMinusE2 = sqrt(1 - e * e);
 
-    // 3. Eccentric Anomaly (E)
-    double E = solveKepler(M, params.eccentricity);
+    // Perifocal (PQW) -> ECI rotation: Rz(raan) * Rx(inc) * Rz(argPerigee)
+    double cosO = cos(deg2rad(params.raan)), sinO = sin(deg2rad(params.raan));
+    double cosI = cos(deg2rad(params.inclination)), sinI = sin(deg2rad(params.inclination));
+    double cosW = cos(deg2rad(params.argPerigee)), sinW = sin(deg2rad(params.argPerigee));
 
-    // 4. True Anomaly (nu)
-    double sqrt_1_e2 = sqrt(1 - params.eccentricity * params.eccentricity);
-    double sin_nu = (sqrt_1_e2 * sin(E)) / (1 - params.eccentricity * cos(E));
-    double cos_nu = (cos(E) - params.eccentricity) / (1 - params.eccentricity * cos(E));
-    double nu = atan2(sin_nu, cos_nu);
+    state.P[0] = cosO * cosW - sinO * sinW * cosI;
+    state.P[1] = sinO * cosW + cosO * sinW * cosI;
+    state.P[2] = sinW * sinI;
+    state.Q[0] = -cosO * sinW - sinO * cosW * cosI;
+    state.Q[1] = -sinO * sinW + cosO * cosW * cosI;
+    state.Q[2] = cosW * sinI;
 
-    // 5. Radius (r)
-    double r = a * (1 - params.eccentricity * cos(E));
+    state.raanRate = 0;
+    state.argPerigeeRate = 0;
+    if (model == PerturbationModel::J2Secular) {
+        // First-order secular J2 rates (Vallado, "Fundamentals of
+        // Astrodynamics", 9.41): nodal regression, apsidal rotation and the
+        // mean motion correction
+        double p = a * (1 - e * e) / EARTH_EQUATORIAL_RADIUS;
+        double k = 1.5 * EARTH_J2 * state.meanMotion / (p * p);
+        state.raanRate = -k * cosI;
+        state.argPerigeeRate = 0.5 * k * (5 * cosI * cosI - 1);
+        state.meanMotion += 0.5 * k * state.sqrtOneMinusE2 * (3 * cosI * cosI - 1);
+    }
+    return state;
+}
 
-    // 6. Position in Orbital Plane (PQW frame)
-    // x' = r * cos(nu)
-    // y' = r * sin(nu)
-    double u = nu + deg2rad(params.argPerigee); // Argument of Latitude
-    double x_orbital = r * cos(u);
-    double y_orbital = r * sin(u);
+template <OrbitKind Kind>
+Position3D propagateOrbitECEF(const OrbitState &state, double time) {
+    // 1. Mean Anomaly (M) at time t
+    double M = state.meanAnomaly0 + state.meanMotion * time;
 
-    // 7. Rotate to ECI (Earth-Centered Inertial)
-    double raan = deg2rad(params.raan);
-    double inc = deg2rad(params.inclination);
+    // 2. Position in Orbital Plane (PQW frame)
+    // x' = r * cos(nu) = a * (cos(E) - e)
+    // y' = r * sin(nu) = a * sqrt(1 - e^2) * sin(E)
+    // J2: perigee has moved by dw along the orbit since t=0
+    double dw = state.argPerigeeRate * time;
+    double x_orbital, y_orbital;
+    if constexpr (Kind == OrbitKind::Circular) {
+        // e = 0: E = M = nu and r = a, nothing to solve
+        x_orbital = state.semiMajorAxis * cos(M + dw);
+        y_orbital = state.semiMajorAxis * sin(M + dw);
+    } else {
+        // Eccentric Anomaly (E)
+        double E = solveKepler(M, state.eccentricity);
+        x_orbital = state.semiMajorAxis * (cos(E) - state.eccentricity);
+        y_orbital = state.semiMajorAxis * state.sqrtOneMinusE2 * sin(E);
+        if (dw != 0) {
+            double x = x_orbital;
+            x_orbital = x * cos(dw) - y_orbital * sin(dw);
+            y_orbital = x * sin(dw) + y_orbital * cos(dw);
+        }
+    }
 
-    double x_eci = x_orbital * cos(raan) - y_orbital * cos(inc) * sin(raan);
-    double y_eci = x_orbital * sin(raan) + y_orbital * cos(inc) * cos(raan);
-    double z_eci = y_orbital * sin(inc);
+    // 3. Rotate to ECI (Earth-Centered Inertial) with the cached basis
+    double x_eci = x_orbital * state.P[0] + y_orbital * state.Q[0];
+    double y_eci = x_orbital * state.P[1] + y_orbital * state.Q[1];
+    double z_eci = x_orbital * state.P[2] + y_orbital * state.Q[2];
 
-    // 8. ECI -> ECEF Transformation (Accounting for Earth Rotation)
-    // Greenwich Sidereal Time (GST) angle
-    double theta_gst = EARTH_ROTATION_RATE * time; // Radyan
+    // 4. ECI -> ECEF Transformation (Accounting for Earth Rotation)
+    // Greenwich Sidereal Time (GST) angle, minus the J2 nodal drift (both
+    // are rotations about z)
+    double theta_gst = (EARTH_ROTATION_RATE - state.raanRate) * time; // Radyan
 
     double x_ecef = x_eci * cos(theta_gst) + y_eci * sin(theta_gst);
     double y_ecef = -x_eci * sin(theta_gst) + y_eci * cos(theta_gst);
@@ -114,6 +153,431 @@ Position3D calculateSatellitePositionECEF(const OrbitParams &params, double time
     return pos;
 }
 
+template Position3D propagateOrbitECEF<OrbitKind::Circular>(const OrbitState &, double);
+template Position3D propagateOrbitECEF<OrbitKind::Elliptical>(const OrbitState &, double);
+
+Position3D calculateSatellitePositionECEF(const OrbitState &state, double time) {
+    if (state.kind == OrbitKind::Circular)
+        return propagateOrbitECEF<OrbitKind::Circular>(state, time);
+    return propagateOrbitECEF<OrbitKind::Elliptical>(state, time);
+}
+
+Position3D calculateSatellitePositionECEF(const OrbitParams &params, double time) {
+    return calculateSatellitePositionECEF(makeOrbitState(params), time);
+}
+
+void calculateSatelliteStateECEF(const OrbitState &state, double time,
+                                 Position3D &pos, Position3D &vel) {
+    double a = state.semiMajorAxis;
+    double e = state.eccentricity;
+    double M = state.meanAnomaly0 + state.meanMotion * time;
+
+    // Position and velocity in the orbital plane (PQW)
+    // dE/dt = n / (1 - e*cos(E))
+    double E = (state.kind == OrbitKind::Circular) ? M : solveKepler(M, e);
+    double sinE = sin(E), cosE = cos(E);
+    double Edot = state.meanMotion / (1 - e * cosE);
+
+    double x_orbital = a * (cosE - e);
+    double y_orbital = a * state.sqrtOneMinusE2 * sinE;
+    double vx_orbital = -a * sinE * Edot;
+    double vy_orbital = a * state.sqrtOneMinusE2 * cosE * Edot;
+
+    // J2 apsidal rotation by dw: r' = R(dw) r, v' = R(dw) (v + wdot * (-y, x))
+    double dw = state.argPerigeeRate * time;
+    if (dw != 0) {
+        double c = cos(dw), s = sin(dw);
+        double vx = vx_orbital - state.argPerigeeRate * y_orbital;
+        double vy = vy_orbital + state.argPerigeeRate * x_orbital;
+        double x = x_orbital;
+        x_orbital = c * x - s * y_orbital;
+        y_orbital = s * x + c * y_orbital;
+        vx_orbital = c * vx - s * vy;
+        vy_orbital = s * vx + c * vy;
+    }
+
+    double x_eci = x_orbital * state.P[0] + y_orbital * state.Q[0];
+    double y_eci = x_orbital * state.P[1] + y_orbital * state.Q[1];
+    double z_eci = x_orbital * state.P[2] + y_orbital * state.Q[2];
+    double vx_eci = vx_orbital * state.P[0] + vy_orbital * state.Q[0];
+    double vy_eci = vx_orbital * state.P[1] + vy_orbital * state.Q[1];
+    double vz_eci = vx_orbital * state.P[2] + vy_orbital * state.Q[2];
+
+    // Earth rotation relative to the (J2-drifting) orbit node
+    double omega = EARTH_ROTATION_RATE - state.raanRate;
+    double theta_gst = omega * time;
+    double cosGst = cos(theta_gst), sinGst = sin(theta_gst);
+
+    pos.x = x_eci * cosGst + y_eci * sinGst;
+    pos.y = -x_eci * sinGst + y_eci * cosGst;
+    pos.z = z_eci;
+
+    // v_ecef = R(-theta) * v_eci - omega x r_ecef
+    vel.x = vx_eci * cosGst + vy_eci * sinGst + omega * pos.y;
+    vel.y = -vx_eci * sinGst + vy_eci * cosGst - omega * pos.x;
+    vel.z = vz_eci;
+}
+
+// --- Batch Propagation ---
+
+void OrbitParamsSoA::push_back(const OrbitState &state) {
+    semiMajorAxis.push_back(state.semiMajorAxis);
+    eccentricity.push_back(state.eccentricity);
+    meanAnomaly0.push_back(state.meanAnomaly0);
+    meanMotion.push_back(state.meanMotion);
+    sqrtOneMinusE2.push_back(state.sqrtOneMinusE2);
+    px.push_back(state.P[0]);
+    py.push_back(state.P[1]);
+    pz.push_back(state.P[2]);
+    qx.push_back(state.Q[0]);
+    qy.push_back(state.Q[1]);
+    qz.push_back(state.Q[2]);
+    raanRate.push_back(state.raanRate);
+    argPerigeeRate.push_back(state.argPerigeeRate);
+    if (state.model == PerturbationModel::J2Secular)
+        model = PerturbationModel::J2Secular;
+}
+
+void OrbitParamsSoA::clear() {
+    semiMajorAxis.clear();
+    eccentricity.clear();
+    meanAnomaly0.clear();
+    meanMotion.clear();
+    sqrtOneMinusE2.clear();
+    px.clear();
+    py.clear();
+    pz.clear();
+    qx.clear();
+    qy.clear();
+    qz.clear();
+    raanRate.clear();
+    argPerigeeRate.clear();
+    model = PerturbationModel::TwoBody;
+}
+
+namespace {
+
+// Round to nearest integer without calling floor()/nearbyint(), which the
+// compiler refuses to vectorize under the default -ftrapping-math.
+// Valid for |v| < 2^51.
+__attribute__((always_inline)) inline double roundMagic(double v) {
+    const double MAGIC = 6755399441055744.0; // 1.5 * 2^52
+    return (v + MAGIC) - MAGIC;
+}
+
+// Branch-free sin/cos (fdlibm kernels + Cody-Waite reduction by pi/2).
+// libm's sin()/cos() are opaque calls that block vectorization; this one is
+// plain arithmetic, so the compiler turns the batch loop into SIMD code.
+// Accurate to ~1 ulp for |x| < 1e6 rad, far beyond any simulated run.
+__attribute__((always_inline)) inline void sinCosPoly(double x, double &s, double &c) {
+    const double INV_PIO2 = 6.36619772367581382433e-01;
+    const double PIO2_1 = 1.57079632673412561417e+00;
+    const double PIO2_2 = 6.07710050630396597660e-11;
+    const double PIO2_3 = 2.02226624871116645580e-21;
+
+    double q = roundMagic(x * INV_PIO2);
+    double r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+    double z = r * r;
+
+    double sr = r + r * z * (-1.66666666666666324348e-01 + z * (8.33333333332248946124e-03
+              + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06
+              + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)))));
+    double cr = 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03
+              + z * (2.48015872894767294178e-05 + z * (-2.75573143513906633035e-07
+              + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+
+    // Quadrant bits as exact 0/1 doubles, so swap and signs are selected by
+    // arithmetic instead of branches:
+    //   q mod 4 = 0: ( s,  c)   1: ( c, -s)   2: (-s, -c)   3: (-c,  s)
+    double quadrant = q - 4.0 * roundMagic(q * 0.25 - 0.375);
+    double half = roundMagic(quadrant * 0.5 - 0.25);
+    double swap = quadrant - 2.0 * half;
+    double cosFlip = half + swap - 2.0 * half * swap;
+
+    s = (1.0 - 2.0 * half) * (swap * cr + (1.0 - swap) * sr);
+    c = (1.0 - 2.0 * cosFlip) * (swap * sr + (1.0 - swap) * cr);
+}
+
+// Shared kernel body. Each target-specific wrapper below inlines it, so the
+// same loop is compiled once per instruction set, orbit kind and force model.
+// With KnownE the eccentric anomaly is taken from 'knownE' (adaptive solver)
+// instead of running the fixed Newton loop. The J2Secular variant adds the
+// apsidal drift to the in-plane angle and evaluates the Earth rotation per
+// satellite (relative to its drifting node); TwoBody shares one rotation.
+template <OrbitKind Kind, PerturbationModel Model, bool KnownE = false>
+__attribute__((always_inline)) inline void propagateRange(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                                                          size_t begin, size_t end,
+                                                          const double *__restrict knownE = nullptr) {
+    const double *__restrict a = params.semiMajorAxis.data();
+    const double *__restrict ecc = params.eccentricity.data();
+    const double *__restrict m0 = params.meanAnomaly0.data();
+    const double *__restrict n = params.meanMotion.data();
+    const double *__restrict sqrt1e2 = params.sqrtOneMinusE2.data();
+    const double *__restrict px = params.px.data();
+    const double *__restrict py = params.py.data();
+    const double *__restrict pz = params.pz.data();
+    const double *__restrict qx = params.qx.data();
+    const double *__restrict qy = params.qy.data();
+    const double *__restrict qz = params.qz.data();
+    const double *__restrict raanRate = params.raanRate.data();
+    const double *__restrict argpRate = params.argPerigeeRate.data();
+    double *__restrict ox = out.x.data();
+    double *__restrict oy = out.y.data();
+    double *__restrict oz = out.z.data();
+
+    // Without J2 the Earth rotation is common to every satellite
+    double theta_gst = EARTH_ROTATION_RATE * time;
+    double cosGst0 = cos(theta_gst);
+    double sinGst0 = sin(theta_gst);
+    const bool secular = Model == PerturbationModel::J2Secular;
+
+    // Inputs and outputs never overlap
+#pragma GCC ivdep
+    for (size_t i = begin; i < end; i++) {
+        double M = m0[i] + n[i] * time;
+
+        // Position in the orbital plane (PQW)
+        double x_orbital, y_orbital;
+        if constexpr (Kind == OrbitKind::Circular) {
+            // Apsidal drift is just an offset of the angle along the orbit
+            double u = secular ? M + argpRate[i] * time : M;
+            double sinM, cosM;
+            sinCosPoly(u, sinM, cosM);
+            x_orbital = a[i] * cosM;
+            y_orbital = a[i] * sinM;
+        } else {
+            double e = ecc[i];
+            double E;
+            if constexpr (KnownE) {
+                E = knownE[i];
+            } else {
+                // Kepler's equation, same fixed iteration count as solveKepler()
+                E = M;
+#pragma GCC unroll 10
+                for (int k = 0; k < 10; k++) {
+                    double sinE, cosE;
+                    sinCosPoly(E, sinE, cosE);
+                    E = E - (E - e * sinE - M) / (1 - e * cosE);
+                }
+            }
+            double sinE, cosE;
+            sinCosPoly(E, sinE, cosE);
+            x_orbital = a[i] * (cosE - e);
+            y_orbital = a[i] * sqrt1e2[i] * sinE;
+            if constexpr (secular) {
+                double sinW, cosW;
+                sinCosPoly(argpRate[i] * time, sinW, cosW);
+                double x = x_orbital;
+                x_orbital = x * cosW - y_orbital * sinW;
+                y_orbital = x * sinW + y_orbital * cosW;
+            }
+        }
+
+        double x_eci = x_orbital * px[i] + y_orbital * qx[i];
+        double y_eci = x_orbital * py[i] + y_orbital * qy[i];
+        double z_eci = x_orbital * pz[i] + y_orbital * qz[i];
+
+        double cosGst = cosGst0, sinGst = sinGst0;
+        if constexpr (secular)
+            sinCosPoly((EARTH_ROTATION_RATE - raanRate[i]) * time, sinGst, cosGst);
+
+        ox[i] = x_eci * cosGst + y_eci * sinGst;
+        oy[i] = -x_eci * sinGst + y_eci * cosGst;
+        oz[i] = z_eci;
+    }
+}
+
+// Adaptive Kepler solve for [begin, end): Newton steps run on chunks of
+// KEPLER_CHUNK satellites (one or two SIMD registers) and stop as soon as
+// every lane of the chunk moved by less than 'tolerance'. Each lane starts
+// from its previous solution advanced by the change in mean anomaly.
+// Returns the number of per-satellite iterations spent.
+const size_t KEPLER_CHUNK = 8;
+
+__attribute__((always_inline)) inline long solveKeplerRange(const OrbitParamsSoA &params, double time,
+                                                            KeplerStateSoA &state, size_t begin, size_t end,
+                                                            double tolerance, int maxIterations) {
+    const double *ecc = params.eccentricity.data();
+    const double *m0 = params.meanAnomaly0.data();
+    const double *n = params.meanMotion.data();
+    double *prevE = state.eccentricAnomaly.data();
+    double *prevM = state.meanAnomaly.data();
+    double tolerance2 = tolerance * tolerance;
+    long iterations = 0;
+
+    for (size_t base = begin; base < end; base += KEPLER_CHUNK) {
+        size_t lanes = end - base < KEPLER_CHUNK ? end - base : KEPLER_CHUNK;
+        double e[KEPLER_CHUNK], M[KEPLER_CHUNK], E[KEPLER_CHUNK];
+
+        // Tail lanes repeat the last satellite so the loops keep a fixed width
+        for (size_t l = 0; l < KEPLER_CHUNK; l++) {
+            size_t i = base + (l < lanes ? l : lanes - 1);
+            e[l] = ecc[i];
+            M[l] = m0[i] + n[i] * time;
+            E[l] = state.warm ? prevE[i] + (M[l] - prevM[i]) : M[l];
+        }
+
+        for (int k = 0; k < maxIterations; k++) {
+            double stepSum2 = 0;
+            for (size_t l = 0; l < KEPLER_CHUNK; l++) {
+                double sinE, cosE;
+                sinCosPoly(E[l], sinE, cosE);
+                double step = (E[l] - e[l] * sinE - M[l]) / (1 - e[l] * cosE);
+                E[l] -= step;
+                stepSum2 += step * step;
+            }
+            iterations += lanes;
+            if (stepSum2 < tolerance2)
+                break;
+        }
+
+        for (size_t l = 0; l < lanes; l++) {
+            prevE[base + l] = E[l];
+            prevM[base + l] = M[l];
+        }
+    }
+    return iterations;
+}
+
+typedef void (*PropagateKernel)(const OrbitParamsSoA &, double, PositionSoA &, size_t, size_t);
+typedef long (*AdaptiveKernel)(const OrbitParamsSoA &, double, PositionSoA &, size_t, size_t,
+                               KeplerStateSoA &, double, int);
+
+template <OrbitKind Kind, PerturbationModel Model>
+void propagateScalar(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                     size_t begin, size_t end) {
+    propagateRange<Kind, Model>(params, time, out, begin, end);
+}
+
+template <PerturbationModel Model>
+long propagateAdaptiveScalar(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                             size_t begin, size_t end, KeplerStateSoA &state,
+                             double tolerance, int maxIterations) {
+    long iterations = solveKeplerRange(params, time, state, begin, end, tolerance, maxIterations);
+    propagateRange<OrbitKind::Elliptical, Model, true>(params, time, out, begin, end,
+                                                       state.eccentricAnomaly.data());
+    return iterations;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MY_LEO_HAVE_X86_KERNELS 1
+
+template <OrbitKind Kind, PerturbationModel Model>
+__attribute__((target("avx2,fma")))
+void propagateAVX2(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                   size_t begin, size_t end) {
+    propagateRange<Kind, Model>(params, time, out, begin, end);
+}
+
+template <OrbitKind Kind, PerturbationModel Model>
+__attribute__((target("avx512f,avx512dq,avx2,fma")))
+void propagateAVX512(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                     size_t begin, size_t end) {
+    propagateRange<Kind, Model>(params, time, out, begin, end);
+}
+
+template <PerturbationModel Model>
+__attribute__((target("avx2,fma")))
+long propagateAdaptiveAVX2(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                           size_t begin, size_t end, KeplerStateSoA &state,
+                           double tolerance, int maxIterations) {
+    long iterations = solveKeplerRange(params, time, state, begin, end, tolerance, maxIterations);
+    propagateRange<OrbitKind::Elliptical, Model, true>(params, time, out, begin, end,
+                                                       state.eccentricAnomaly.data());
+    return iterations;
+}
+
+template <PerturbationModel Model>
+__attribute__((target("avx512f,avx512dq,avx2,fma")))
+long propagateAdaptiveAVX512(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                             size_t begin, size_t end, KeplerStateSoA &state,
+                             double tolerance, int maxIterations) {
+    long iterations = solveKeplerRange(params, time, state, begin, end, tolerance, maxIterations);
+    propagateRange<OrbitKind::Elliptical, Model, true>(params, time, out, begin, end,
+                                                       state.eccentricAnomaly.data());
+    return iterations;
+}
+#endif
+
+// Kernels for one force model
+struct KernelSet {
+    PropagateKernel circular;
+    PropagateKernel elliptical;
+    AdaptiveKernel adaptive;
+};
+
+struct KernelChoice {
+    KernelSet twoBody;
+    KernelSet j2Secular;
+    const char *name;
+
+    const KernelSet &get(PerturbationModel model) const {
+        return model == PerturbationModel::J2Secular ? j2Secular : twoBody;
+    }
+};
+
+#define MY_LEO_KERNEL_SET(prefix, adaptivePrefix, model) \
+    {prefix<OrbitKind::Circular, model>, prefix<OrbitKind::Elliptical, model>, adaptivePrefix<model>}
+
+KernelChoice selectKernel() {
+    const PerturbationModel TWO_BODY = PerturbationModel::TwoBody;
+    const PerturbationModel J2 = PerturbationModel::J2Secular;
+#ifdef MY_LEO_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        return {MY_LEO_KERNEL_SET(propagateAVX512, propagateAdaptiveAVX512, TWO_BODY),
+                MY_LEO_KERNEL_SET(propagateAVX512, propagateAdaptiveAVX512, J2), "avx512"};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return {MY_LEO_KERNEL_SET(propagateAVX2, propagateAdaptiveAVX2, TWO_BODY),
+                MY_LEO_KERNEL_SET(propagateAVX2, propagateAdaptiveAVX2, J2), "avx2"};
+#endif
+    return {MY_LEO_KERNEL_SET(propagateScalar, propagateAdaptiveScalar, TWO_BODY),
+            MY_LEO_KERNEL_SET(propagateScalar, propagateAdaptiveScalar, J2), "scalar"};
+}
+
+#undef MY_LEO_KERNEL_SET
+
+const KernelChoice &activeKernel() {
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+} // namespace
+
+void propagateBatch(const OrbitParamsSoA &params, double time, PositionSoA &out) {
+    out.resize(params.size());
+    activeKernel().get(params.model).elliptical(params, time, out, 0, params.size());
+}
+
+void propagateBatch(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                    size_t begin, size_t end) {
+    activeKernel().get(params.model).elliptical(params, time, out, begin, end);
+}
+
+template <OrbitKind Kind>
+void propagateBatch(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                    size_t begin, size_t end) {
+    const KernelSet &kernels = activeKernel().get(params.model);
+    if (Kind == OrbitKind::Circular)
+        kernels.circular(params, time, out, begin, end);
+    else
+        kernels.elliptical(params, time, out, begin, end);
+}
+
+template void propagateBatch<OrbitKind::Circular>(const OrbitParamsSoA &, double,
+                                                  PositionSoA &, size_t, size_t);
+template void propagateBatch<OrbitKind::Elliptical>(const OrbitParamsSoA &, double,
+                                                    PositionSoA &, size_t, size_t);
+
+long propagateBatchAdaptive(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                            size_t begin, size_t end, KeplerStateSoA &state,
+                            double tolerance, int maxIterations) {
+    return activeKernel().get(params.model).adaptive(params, time, out, begin, end, state,
+                                                     tolerance, maxIterations);
+}
+
+const char *propagateBatchKernelName() { return activeKernel().name; }
+
 GeoCoord ecefToGeo(const Position3D &pos) {
     GeoCoord geo;
     double r = sqrt(pos.x*pos.x + pos.y*pos.y + pos.z*pos.z);
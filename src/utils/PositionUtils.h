@@ -2,11 +2,16 @@
 #define __MY_LEO_POSITIONUTILS_H
 
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 // --- Constants ---
 const double EARTH_RADIUS = 6371.0;          // km
 const double EARTH_GRAVITATIONAL_MU = 398600.4418; // km^3/s^2
 const double EARTH_ROTATION_RATE = 7.2921159e-5;   // rad/s (approx)
+const double EARTH_EQUATORIAL_RADIUS = 6378.137;    // km (WGS-84), J2 reference radius
+const double EARTH_J2 = 1.08262668e-3;
+const double SPEED_OF_LIGHT = 299792.458;          // km/s
 
 struct OrbitParams {
   // Keplerian Elements
@@ -18,6 +23,45 @@ struct OrbitParams {
   double trueAnomaly;      // nu (degrees) - Initial position in orbit
 };
 
+// Orbit shape, used to pick a specialized propagator at compile time.
+// Circular orbits skip Kepler's equation entirely (E = M = nu, r = a).
+enum class OrbitKind { Circular, Elliptical };
+
+inline OrbitKind orbitKindOf(const OrbitParams &params) {
+  return params.eccentricity == 0.0 ? OrbitKind::Circular : OrbitKind::Elliptical;
+}
+
+// Force model used to derive the orbit's time evolution.
+//   TwoBody   - fixed Keplerian ellipse
+//   J2Secular - Earth oblateness, secular terms only: RAAN and argument of
+//               perigee drift linearly and the mean motion is corrected.
+//               Keeps multi-day runs accurate (Walker planes precess by
+//               several degrees per day) at the cost of one extra angle
+//               evaluation per satellite per tick.
+enum class PerturbationModel { TwoBody, J2Secular };
+
+// Everything about an orbit that does not depend on time, derived once from
+// OrbitParams so that propagation only evaluates the anomaly and the Earth
+// rotation. P and Q span the orbital plane in ECI: P points to perigee and
+// Q is 90 deg ahead in the direction of motion, i.e. the first two columns of
+// Rz(raan) * Rx(inc) * Rz(argPerigee).
+struct OrbitState {
+  double semiMajorAxis;  // km
+  double eccentricity;
+  double meanMotion;     // rad/s
+  double meanAnomaly0;   // rad (at t=0)
+  double sqrtOneMinusE2;
+  double P[3];           // basis at t=0 (raan, argPerigee drift from here)
+  double Q[3];
+  double raanRate;       // rad/s, 0 for TwoBody
+  double argPerigeeRate; // rad/s, 0 for TwoBody
+  OrbitKind kind;
+  PerturbationModel model;
+};
+
+OrbitState makeOrbitState(const OrbitParams &params,
+                          PerturbationModel model = PerturbationModel::TwoBody);
+
 struct GeoCoord {
     double latitude;  // degrees
     double longitude; // degrees
@@ -35,7 +79,88 @@ Position3D geoToECEF(const GeoCoord &geo);
 Position3D rotateWithEarth(const Position3D &initialECEF, double time);
 
 // 3. Propagate Satellite Orbit in ECI and convert to ECEF
+// Dispatches to propagateOrbitECEF<Circular> when eccentricity is zero.
+// Prefer the OrbitState overload in loops; the OrbitParams one derives the
+// state on every call.
 Position3D calculateSatellitePositionECEF(const OrbitParams &params, double time);
+Position3D calculateSatellitePositionECEF(const OrbitState &state, double time);
+
+// Position and velocity (km/s) in ECEF, velocity including the Earth
+// rotation term. Used to build interpolation tables.
+void calculateSatelliteStateECEF(const OrbitState &state, double time,
+                                 Position3D &pos, Position3D &vel);
+
+// Propagator specialized on orbit kind (instantiated for both kinds)
+template <OrbitKind Kind>
+Position3D propagateOrbitECEF(const OrbitState &state, double time);
+
+// --- Batch Propagation (Structure-of-Arrays) ---
+// OrbitState of many satellites, stored column-wise so the batch kernel
+// can process several satellites per SIMD register.
+struct OrbitParamsSoA {
+  std::vector<double> semiMajorAxis; // km
+  std::vector<double> eccentricity;
+  std::vector<double> meanAnomaly0;  // rad (initialAngle at t=0)
+  std::vector<double> meanMotion;    // rad/s
+  std::vector<double> sqrtOneMinusE2;
+  std::vector<double> px, py, pz;    // perifocal -> ECI basis
+  std::vector<double> qx, qy, qz;
+  std::vector<double> raanRate;       // rad/s (J2Secular only)
+  std::vector<double> argPerigeeRate; // rad/s (J2Secular only)
+
+  // J2Secular as soon as one entry uses it; selects the drifting kernels
+  PerturbationModel model = PerturbationModel::TwoBody;
+
+  void push_back(const OrbitState &state);
+  void push_back(const OrbitParams &params) { push_back(makeOrbitState(params)); }
+  void clear();
+  size_t size() const { return semiMajorAxis.size(); }
+};
+
+struct PositionSoA {
+  std::vector<double> x, y, z; // ECEF (km)
+
+  void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+  size_t size() const { return x.size(); }
+};
+
+// Per-satellite Kepler solution from the previous solve, used to warm-start
+// the adaptive solver. Indexed like the OrbitParamsSoA it is used with.
+struct KeplerStateSoA {
+  std::vector<double> eccentricAnomaly; // E (rad)
+  std::vector<double> meanAnomaly;      // M the above E solves (rad)
+  bool warm = false;                    // set by the caller after the first solve
+
+  void resize(size_t n) { eccentricAnomaly.resize(n); meanAnomaly.resize(n); }
+};
+
+// 4. Propagate a whole batch of orbits to ECEF at 'time'.
+// Produces the same positions as calculateSatellitePositionECEF(), using the
+// widest SIMD kernel the CPU supports (AVX-512, AVX2 or portable scalar).
+// Handles any eccentricity. J2 drift is applied when params.model says so.
+void propagateBatch(const OrbitParamsSoA &params, double time, PositionSoA &out);
+
+// Same as above, restricted to entries [begin, end)
+void propagateBatch(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                    size_t begin, size_t end);
+
+// Kind-specialized batch: every entry in [begin, end) must be of 'Kind'
+template <OrbitKind Kind>
+void propagateBatch(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                    size_t begin, size_t end);
+
+// Elliptical batch with an adaptive Kepler solver: Newton iterations stop once
+// the correction is below 'tolerance' (rad) for a whole SIMD chunk, or after
+// 'maxIterations'. Starts from the previous solution kept in 'state' (if
+// state.warm) and updates entries [begin, end) only, so disjoint ranges may
+// be solved concurrently; set state.warm once every range has been solved.
+// Returns the number of per-satellite iterations spent.
+long propagateBatchAdaptive(const OrbitParamsSoA &params, double time, PositionSoA &out,
+                            size_t begin, size_t end, KeplerStateSoA &state,
+                            double tolerance, int maxIterations);
+
+// Name of the kernel selected at runtime ("avx512", "avx2" or "scalar")
+const char *propagateBatchKernelName();
 
 // --- New Visualization Utils ---
 // Convert ECEF back to Lat/Lon (for map display)
@@ -0,0 +1,296 @@
+#include "Sgp4.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// WGS-72 gravity model (the one TLEs are fitted with)
+static const double RE = 6378.135;                      // km
+static const double MU = 398600.8;                      // km^3/s^2
+static const double XKE = 60.0 / sqrt(RE * RE * RE / MU); // sqrt(mu) in earth radii^1.5/min
+static const double J2 = 0.001082616;
+static const double J3 = -0.00000253881;
+static const double J4 = -0.00000165597;
+static const double J3OJ2 = J3 / J2;
+static const double X2O3 = 2.0 / 3.0;
+static const double TWO_PI = 2 * M_PI;
+static const double DEEP_SPACE_PERIOD = 225.0; // min
+
+double sgp4BrouwerMeanMotion(const TleRecord &tle) {
+    double noKozai = tle.meanMotion * TWO_PI / 1440.0;
+    double eccsq = tle.eccentricity * tle.eccentricity;
+    double omeosq = 1 - eccsq;
+    double cosio = cos(tle.inclination * M_PI / 180.0);
+    double ak = pow(XKE / noKozai, X2O3);
+    double d1 = 0.75 * J2 * (3 * cosio * cosio - 1) / (sqrt(omeosq) * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1 - del * del - del * (1.0 / 3.0 + 134 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    return noKozai / (1 + del);
+}
+
+bool sgp4Init(const TleRecord &tle, double age, Sgp4Record &rec) {
+    const double deg = M_PI / 180.0;
+    rec.inclo = tle.inclination * deg;
+    rec.nodeo = tle.raan * deg;
+    rec.ecco = tle.eccentricity;
+    rec.argpo = tle.argPerigee * deg;
+    rec.mo = tle.meanAnomaly * deg;
+    rec.noKozai = tle.meanMotion * TWO_PI / 1440.0;
+    rec.bstar = tle.bstar;
+    rec.tsince0 = age / 60.0;
+    rec.gmst0 = greenwichSiderealTime(tle.epochJulianDate + age / 86400.0);
+    if (rec.noKozai <= 0 || rec.ecco < 0 || rec.ecco >= 1)
+        return false;
+
+    double eccsq = rec.ecco * rec.ecco;
+    double omeosq = 1 - eccsq;
+    double rteosq = sqrt(omeosq);
+    double cosio = cos(rec.inclo);
+    double cosio2 = cosio * cosio;
+    rec.no = sgp4BrouwerMeanMotion(tle);
+    rec.ao = pow(XKE / rec.no, X2O3);
+
+    if (TWO_PI / rec.no >= DEEP_SPACE_PERIOD)
+        return false;
+
+    double sinio = sin(rec.inclo);
+    double po = rec.ao * omeosq;
+    double con42 = 1 - 5 * cosio2;
+    rec.con41 = -con42 - cosio2 - cosio2;
+    double posq = po * po;
+    double rp = rec.ao * (1 - rec.ecco);
+
+    // Atmospheric density parameters, lowered for perigees below 156 km
+    double ss = 78.0 / RE + 1;
+    double qzms2t = pow((120.0 - 78.0) / RE, 4);
+    rec.simple = rp < 220.0 / RE + 1;
+    double sfour = ss;
+    double qzms24 = qzms2t;
+    double perigee = (rp - 1) * RE;
+    if (perigee < 156) {
+        sfour = perigee < 98 ? 20 : perigee - 78;
+        qzms24 = pow((120 - sfour) / RE, 4);
+        sfour = sfour / RE + 1;
+    }
+
+    double pinvsq = 1 / posq;
+    double tsi = 1 / (rec.ao - sfour);
+    rec.eta = rec.ao * rec.ecco * tsi;
+    double etasq = rec.eta * rec.eta;
+    double eeta = rec.ecco * rec.eta;
+    double psisq = fabs(1 - etasq);
+    double coef = qzms24 * pow(tsi, 4);
+    double coef1 = coef / pow(psisq, 3.5);
+    double cc2 = coef1 * rec.no *
+                 (rec.ao * (1 + 1.5 * etasq + eeta * (4 + etasq)) +
+                  0.375 * J2 * tsi / psisq * rec.con41 * (8 + 3 * etasq * (8 + etasq)));
+    rec.cc1 = rec.bstar * cc2;
+    double cc3 = rec.ecco > 1.0e-4 ? -2 * coef * tsi * J3OJ2 * rec.no * sinio / rec.ecco : 0;
+    rec.x1mth2 = 1 - cosio2;
+    rec.cc4 = 2 * rec.no * coef1 * rec.ao * omeosq *
+              (rec.eta * (2 + 0.5 * etasq) + rec.ecco * (0.5 + 2 * etasq) -
+               J2 * tsi / (rec.ao * psisq) *
+                   (-3 * rec.con41 * (1 - 2 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+                    0.75 * rec.x1mth2 * (2 * etasq - eeta * (1 + etasq)) * cos(2 * rec.argpo)));
+    rec.cc5 = 2 * coef1 * rec.ao * omeosq * (1 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    // Secular rates
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * J2 * pinvsq * rec.no;
+    double temp2 = 0.5 * temp1 * J2 * pinvsq;
+    double temp3 = -0.46875 * J4 * pinvsq * pinvsq * rec.no;
+    rec.mdot = rec.no + 0.5 * temp1 * rteosq * rec.con41 +
+               0.0625 * temp2 * rteosq * (13 - 78 * cosio2 + 137 * cosio4);
+    rec.argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7 - 114 * cosio2 + 395 * cosio4) +
+                  temp3 * (3 - 36 * cosio2 + 49 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    rec.nodedot = xhdot1 + (0.5 * temp2 * (4 - 19 * cosio2) + 2 * temp3 * (3 - 7 * cosio2)) * cosio;
+
+    rec.omgcof = rec.bstar * cc3 * cos(rec.argpo);
+    rec.xmcof = rec.ecco > 1.0e-4 ? -X2O3 * coef * rec.bstar / eeta : 0;
+    rec.nodecf = 3.5 * omeosq * xhdot1 * rec.cc1;
+    rec.t2cof = 1.5 * rec.cc1;
+    // Avoid the division by zero for i = 180 deg
+    double onePlusCos = fabs(cosio + 1) > 1.5e-12 ? 1 + cosio : 1.5e-12;
+    rec.xlcof = -0.25 * J3OJ2 * sinio * (3 + 5 * cosio) / onePlusCos;
+    rec.aycof = -0.5 * J3OJ2 * sinio;
+    rec.delmo = pow(1 + rec.eta * cos(rec.mo), 3);
+    rec.sinmao = sin(rec.mo);
+    rec.x7thm1 = 7 * cosio2 - 1;
+
+    // Higher order drag terms, dropped for very low perigees
+    rec.d2 = rec.d3 = rec.d4 = 0;
+    rec.t3cof = rec.t4cof = rec.t5cof = 0;
+    if (!rec.simple) {
+        double cc1sq = rec.cc1 * rec.cc1;
+        rec.d2 = 4 * rec.ao * tsi * cc1sq;
+        double temp = rec.d2 * tsi * rec.cc1 / 3.0;
+        rec.d3 = (17 * rec.ao + sfour) * temp;
+        rec.d4 = 0.5 * temp * rec.ao * tsi * (221 * rec.ao + 31 * sfour) * rec.cc1;
+        rec.t3cof = rec.d2 + 2 * cc1sq;
+        rec.t4cof = 0.25 * (3 * rec.d3 + rec.cc1 * (12 * rec.d2 + 10 * cc1sq));
+        rec.t5cof = 0.2 * (3 * rec.d4 + 12 * rec.cc1 * rec.d3 + 6 * rec.d2 * rec.d2 +
+                           15 * cc1sq * (2 * rec.d2 + cc1sq));
+    }
+    return true;
+}
+
+bool sgp4Propagate(const Sgp4Record &rec, double t, double r[3], double v[3]) {
+    // Secular gravity and drag
+    double xmdf = rec.mo + rec.mdot * t;
+    double argpdf = rec.argpo + rec.argpdot * t;
+    double nodedf = rec.nodeo + rec.nodedot * t;
+    double argpm = argpdf;
+    double mm = xmdf;
+    double t2 = t * t;
+    double nodem = nodedf + rec.nodecf * t2;
+    double tempa = 1 - rec.cc1 * t;
+    double tempe = rec.bstar * rec.cc4 * t;
+    double templ = rec.t2cof * t2;
+
+    if (!rec.simple) {
+        double delomg = rec.omgcof * t;
+        double delmtemp = 1 + rec.eta * cos(xmdf);
+        double delm = rec.xmcof * (delmtemp * delmtemp * delmtemp - rec.delmo);
+        double temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        tempa = tempa - rec.d2 * t2 - rec.d3 * t3 - rec.d4 * t4;
+        tempe = tempe + rec.bstar * rec.cc5 * (sin(mm) - rec.sinmao);
+        templ = templ + rec.t3cof * t3 + t4 * (rec.t4cof + t * rec.t5cof);
+    }
+
+    double am = pow(XKE / rec.no, X2O3) * tempa * tempa;
+    double nm = XKE / pow(am, 1.5);
+    double em = rec.ecco - tempe;
+    if (em >= 1 || em < -0.001 || am < 0.95)
+        return false;
+    if (em < 1.0e-6)
+        em = 1.0e-6;
+    mm = mm + rec.no * templ;
+    double xlm = mm + argpm + nodem;
+
+    nodem = fmod(nodem, TWO_PI);
+    argpm = fmod(argpm, TWO_PI);
+    xlm = fmod(xlm, TWO_PI);
+    mm = fmod(xlm - argpm - nodem, TWO_PI);
+
+    double sinim = sin(rec.inclo);
+    double cosim = cos(rec.inclo);
+
+    // Long period periodics
+    double axnl = em * cos(argpm);
+    double temp = 1 / (am * (1 - em * em));
+    double aynl = em * sin(argpm) + temp * rec.aycof;
+    double xl = mm + argpm + nodem + temp * rec.xlcof * axnl;
+
+    // Kepler's equation in the equinoctial form
+    double u = fmod(xl - nodem, TWO_PI);
+    double eo1 = u;
+    double tem5 = 9999.9;
+    double sineo1 = 0, coseo1 = 0;
+    for (int ktr = 1; fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        tem5 = 1 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (fabs(tem5) >= 0.95)
+            tem5 = tem5 > 0 ? 0.95 : -0.95;
+        eo1 += tem5;
+    }
+
+    // Short period periodics
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2 = axnl * axnl + aynl * aynl;
+    double pl = am * (1 - el2);
+    if (pl < 0)
+        return false;
+    double rl = am * (1 - ecose);
+    double rdotl = sqrt(am) * esine / rl;
+    double rvdotl = sqrt(pl) / rl;
+    double betal = sqrt(1 - el2);
+    temp = esine / (1 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1 - 2 * sinu * sinu;
+    temp = 1 / pl;
+    double temp1 = 0.5 * J2 * temp;
+    double temp2 = temp1 * temp;
+
+    double mrt = rl * (1 - 1.5 * temp2 * betal * rec.con41) + 0.5 * temp1 * rec.x1mth2 * cos2u;
+    su = su - 0.25 * temp2 * rec.x7thm1 * sin2u;
+    double xnode = nodem + 1.5 * temp2 * cosim * sin2u;
+    double xinc = rec.inclo + 1.5 * temp2 * cosim * sinim * cos2u;
+    double mvt = rdotl - nm * temp1 * rec.x1mth2 * sin2u / XKE;
+    double rvdot = rvdotl + nm * temp1 * (rec.x1mth2 * cos2u + 1.5 * rec.con41) / XKE;
+
+    // Orientation vectors
+    double sinsu = sin(su), cossu = cos(su);
+    double snod = sin(xnode), cnod = cos(xnode);
+    double sini = sin(xinc), cosi = cos(xinc);
+    double xmx = -snod * cosi;
+    double xmy = cnod * cosi;
+    double ux = xmx * sinsu + cnod * cossu;
+    double uy = xmy * sinsu + snod * cossu;
+    double uz = sini * sinsu;
+    double vx = xmx * cossu - cnod * sinsu;
+    double vy = xmy * cossu - snod * sinsu;
+    double vz = sini * cossu;
+
+    const double vkmpersec = RE * XKE / 60.0;
+    r[0] = mrt * ux * RE;
+    r[1] = mrt * uy * RE;
+    r[2] = mrt * uz * RE;
+    v[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+    v[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+    v[2] = (mvt * uz + rvdot * vz) * vkmpersec;
+
+    // Below the surface: decayed
+    return mrt >= 1;
+}
+
+bool sgp4StateECEF(const Sgp4Record &rec, double time, Position3D &pos, Position3D &vel) {
+    double r[3], v[3];
+    if (!sgp4Propagate(rec, rec.tsince0 + time / 60.0, r, v))
+        return false;
+
+    // TEME -> ECEF: rotate by the sidereal angle, then remove the frame
+    // rotation from the velocity
+    double theta = rec.gmst0 + EARTH_ROTATION_RATE * time;
+    double c = cos(theta), s = sin(theta);
+    pos.x = c * r[0] + s * r[1];
+    pos.y = -s * r[0] + c * r[1];
+    pos.z = r[2];
+    vel.x = c * v[0] + s * v[1] + EARTH_ROTATION_RATE * pos.y;
+    vel.y = -s * v[0] + c * v[1] - EARTH_ROTATION_RATE * pos.x;
+    vel.z = v[2];
+    return true;
+}
+
+bool sgp4PositionECEF(const Sgp4Record &rec, double time, Position3D &pos) {
+    Position3D vel;
+    return sgp4StateECEF(rec, time, pos, vel);
+}
+
+size_t propagateSgp4Batch(const std::vector<Sgp4Record> &records, double time,
+                          PositionSoA &out, size_t outOffset, size_t begin, size_t end) {
+    size_t failed = 0;
+    for (size_t k = begin; k < end; k++) {
+        Position3D pos;
+        if (!sgp4PositionECEF(records[k], time, pos)) {
+            failed++;
+            continue;
+        }
+        out.x[outOffset + k] = pos.x;
+        out.y[outOffset + k] = pos.y;
+        out.z[outOffset + k] = pos.z;
+    }
+    return failed;
+}
@@ -0,0 +1,73 @@
+#ifndef __MY_LEO_SGP4_H
+#define __MY_LEO_SGP4_H
+
+#include "PositionUtils.h"
+#include "TleReader.h"
+#include <cstddef>
+#include <vector>
+
+// SGP4 propagator for NORAD element sets (Hoots & Roehrich, Spacetrack
+// Report #3, as revised by Vallado et al. 2006), near-Earth branch only:
+// orbital periods below 225 minutes, which covers every LEO shell. Deep
+// space sets (SDP4, lunar/solar terms) are not supported; sgp4Init()
+// rejects them.
+//
+// TLE mean elements are only meaningful through SGP4: it recovers the
+// Brouwer mean motion from the Kozai one, applies the J2/J3/J4 secular and
+// periodic terms and the BSTAR drag decay. Constants are WGS-72, as used to
+// fit the published element sets.
+//
+// Output is rotated from TEME into the simulation's ECEF frame (Greenwich
+// at angle 'gmst0' at t = 0, then EARTH_ROTATION_RATE), the same frame the
+// Kepler propagator and the ground stations use.
+struct Sgp4Record {
+  // Elements at the TLE epoch (rad, rad/min)
+  double inclo, nodeo, ecco, argpo, mo;
+  double noKozai;   // mean motion as published
+  double no;        // Brouwer (un-Kozai'd) mean motion
+  double bstar;     // 1/earth radii
+  double ao;        // Brouwer semi-major axis (earth radii)
+
+  // Time mapping: minutes since the TLE epoch at simulation time 0, and
+  // Greenwich sidereal angle (rad) at simulation time 0
+  double tsince0;
+  double gmst0;
+
+  // Derived once by sgp4Init()
+  bool simple;      // perigee below 220 km: truncated drag terms
+  double con41, x1mth2, x7thm1;
+  double cc1, cc4, cc5, d2, d3, d4;
+  double delmo, eta, sinmao;
+  double mdot, argpdot, nodedot;
+  double omgcof, xmcof, nodecf, xlcof, aycof;
+  double t2cof, t3cof, t4cof, t5cof;
+};
+
+// Brouwer mean motion (rad/min) of an element set: the published Kozai
+// mean motion with the J2 part of the period removed
+double sgp4BrouwerMeanMotion(const TleRecord &tle);
+
+// Derive the propagation constants of 'tle'. 'age' is the time (s) from the
+// TLE epoch to simulation time 0. Returns false for deep space (period
+// >= 225 min) or invalid elements.
+bool sgp4Init(const TleRecord &tle, double age, Sgp4Record &record);
+
+// Osculating TEME position (km) and velocity (km/s) 'tsince' minutes after
+// the TLE epoch. Returns false once the elements become invalid (eccentricity
+// outside [0, 1) after drag, or the satellite has decayed).
+bool sgp4Propagate(const Sgp4Record &record, double tsince, double r[3], double v[3]);
+
+// ECEF position, and velocity including the Earth rotation term, at
+// simulation time 'time' (s)
+bool sgp4StateECEF(const Sgp4Record &record, double time, Position3D &pos,
+                   Position3D &vel);
+bool sgp4PositionECEF(const Sgp4Record &record, double time, Position3D &pos);
+
+// Propagate records [begin, end) to 'time', writing record k to entry
+// outOffset + k of 'out'. Only touches that slice, so disjoint ranges may
+// run in parallel. Returns the number of records that failed; their
+// entries are left unchanged.
+size_t propagateSgp4Batch(const std::vector<Sgp4Record> &records, double time,
+                          PositionSoA &out, size_t outOffset, size_t begin, size_t end);
+
+#endif
@@ -0,0 +1,155 @@
+#include "ShortestPaths.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace {
+
+const double INFINITE_DISTANCE = std::numeric_limits<double>::infinity();
+
+// Min-heap with lazy deletion: stale entries are skipped when popped
+const std::greater<std::pair<double, int>> later;
+
+void push(ShortestPathWorkspace &ws, double distance, int node) {
+    ws.heap.emplace_back(distance, node);
+    std::push_heap(ws.heap.begin(), ws.heap.end(), later);
+}
+
+void prepare(ShortestPathWorkspace &ws, int numNodes) {
+    if ((int)ws.affected.size() < numNodes) {
+        ws.affected.resize(numNodes, 0);
+        ws.touched.resize(numNodes, 0);
+    }
+    ws.heap.clear();
+}
+
+} // namespace
+
+void ShortestPathTree::attach(int node, int via, double distance) {
+    dist[node] = distance;
+    parent[node] = via;
+    firstHop[node] = via == source ? node : firstHop[via];
+}
+
+void ShortestPathTree::touch(int node, ShortestPathWorkspace &ws, std::vector<int> &changed) {
+    if (!ws.touched[node]) {
+        ws.touched[node] = 1;
+        changed.push_back(node);
+    }
+}
+
+void ShortestPathTree::build(const ContactGraph &graph, int src, ShortestPathWorkspace &ws,
+                             std::vector<int> &changed) {
+    source = src;
+    dist.assign(graph.numNodes, INFINITE_DISTANCE);
+    parent.assign(graph.numNodes, -1);
+    firstHop.assign(graph.numNodes, -1);
+    prepare(ws, graph.numNodes);
+
+    dist[source] = 0;
+    push(ws, 0.0, source);
+    size_t first = changed.size();
+    propagate(graph, ws, changed);
+
+    // Everything is new; report each node once
+    for (size_t i = first; i < changed.size(); i++)
+        ws.touched[changed[i]] = 0;
+    changed.resize(first);
+    for (int v = 0; v < graph.numNodes; v++)
+        if (v != source)
+            changed.push_back(v);
+}
+
+void ShortestPathTree::update(const ContactGraph &graph, const std::vector<EdgeChange> &changes,
+                              ShortestPathWorkspace &ws, std::vector<int> &changed) {
+    prepare(ws, graph.numNodes);
+    size_t first = changed.size();
+
+    // 1. Detach the subtrees hanging below removed or lengthened tree edges
+    ws.stack.clear();
+    for (const EdgeChange &c : changes) {
+        if (parent[c.to] != c.from || ws.affected[c.to])
+            continue;
+        if (c.removed || dist[c.from] + c.distance > dist[c.to]) {
+            ws.affected[c.to] = 1;
+            ws.stack.push_back(c.to);
+        }
+    }
+    // The subtree of v is found by following v's edges to nodes that have
+    // v as parent, so this is linear in the detached part only
+    std::vector<int> &detached = ws.stack;
+    for (size_t i = 0; i < detached.size(); i++) {
+        int v = detached[i];
+        if (!isTransit(graph, v))
+            continue;
+        for (uint32_t e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            int w = graph.target[e];
+            if (parent[w] == v && !ws.affected[w]) {
+                ws.affected[w] = 1;
+                detached.push_back(w);
+            }
+        }
+    }
+    for (int v : detached) {
+        dist[v] = INFINITE_DISTANCE;
+        parent[v] = -1;
+        firstHop[v] = -1;
+        touch(v, ws, changed);
+    }
+
+    // 2. Re-attach each detached node to its best unaffected neighbour.
+    // Links are symmetric, so v's out-edges are also its in-edges.
+    for (int v : detached) {
+        for (uint32_t e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            int p = graph.target[e];
+            if (ws.affected[p] || !isTransit(graph, p))
+                continue;
+            double d = dist[p] + graph.distance[e];
+            if (d < dist[v])
+                attach(v, p, d);
+        }
+        if (dist[v] < INFINITE_DISTANCE)
+            push(ws, dist[v], v);
+    }
+    for (int v : detached)
+        ws.affected[v] = 0;
+
+    // 3. Added or shortened edges that improve their head
+    for (const EdgeChange &c : changes) {
+        if (c.removed || !isTransit(graph, c.from))
+            continue;
+        double d = dist[c.from] + c.distance;
+        if (d < dist[c.to]) {
+            attach(c.to, c.from, d);
+            touch(c.to, ws, changed);
+            push(ws, d, c.to);
+        }
+    }
+
+    propagate(graph, ws, changed);
+    for (size_t i = first; i < changed.size(); i++)
+        ws.touched[changed[i]] = 0;
+}
+
+// Dijkstra from the nodes in the heap over the current distances
+void ShortestPathTree::propagate(const ContactGraph &graph, ShortestPathWorkspace &ws,
+                                 std::vector<int> &changed) {
+    while (!ws.heap.empty()) {
+        std::pop_heap(ws.heap.begin(), ws.heap.end(), later);
+        double d = ws.heap.back().first;
+        int v = ws.heap.back().second;
+        ws.heap.pop_back();
+        if (d > dist[v] || !isTransit(graph, v))
+            continue;
+
+        for (uint32_t e = graph.edgesBegin(v); e < graph.edgesEnd(v); e++) {
+            int w = graph.target[e];
+            double dw = d + graph.distance[e];
+            if (dw < dist[w]) {
+                attach(w, v, dw);
+                touch(w, ws, changed);
+                push(ws, dw, w);
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef __MY_LEO_SHORTESTPATHS_H
+#define __MY_LEO_SHORTESTPATHS_H
+
+#include "ContactGraph.h"
+#include <utility>
+#include <vector>
+
+// A change of one directed edge of the contact graph
+struct EdgeChange {
+    int from, to;     // nodes
+    double distance;  // new length (km), ignored if removed
+    bool removed;
+};
+
+// Per-thread scratch space, reused across sources so updates allocate
+// nothing once the vectors have grown to the graph size
+struct ShortestPathWorkspace {
+    std::vector<std::pair<double, int>> heap;
+    std::vector<int> stack;
+    std::vector<char> affected;  // per node, all zero between calls
+    std::vector<char> touched;   // per node, all zero between calls
+};
+
+// Shortest-path tree of one source over the edge distances of a contact
+// graph, kept up to date as edges change (dynamic SSSP in the style of
+// Ramalingam-Reps). Ground stations are endpoints only: their out-edges
+// are used when the station is the source, never as a transit hop.
+//
+// build() is a plain Dijkstra. update() repairs the tree after a batch of
+// edge changes in time proportional to the part of the tree that actually
+// changes:
+//  - a removed or lengthened tree edge detaches the subtree below it; its
+//    nodes are re-attached from their best unaffected neighbour,
+//  - an added or shortened edge that improves its head is relaxed from
+//    there,
+// and one Dijkstra pass seeded with just those nodes settles the rest.
+// Edges that change off the tree and improve nothing cost O(1).
+//
+// Node numbering must stay the same across the graphs passed in.
+class ShortestPathTree {
+
+public:
+    void build(const ContactGraph &graph, int source, ShortestPathWorkspace &ws,
+               std::vector<int> &changed);
+    // 'graph' already contains the changes. Nodes whose distance or first
+    // hop may have changed are appended to 'changed' (each once).
+    void update(const ContactGraph &graph, const std::vector<EdgeChange> &changes,
+                ShortestPathWorkspace &ws, std::vector<int> &changed);
+
+    int getSource() const { return source; }
+    bool reachable(int node) const { return firstHop[node] >= 0; }
+    double distanceTo(int node) const { return dist[node]; }  // km
+    // Neighbour of the source the path to 'node' starts with, -1 if none
+    int firstHopTo(int node) const { return firstHop[node]; }
+
+private:
+    int source = -1;
+    std::vector<double> dist;
+    std::vector<int> parent;
+    std::vector<int> firstHop;
+
+    bool isTransit(const ContactGraph &graph, int node) const {
+        return node == source || graph.isSatellite(node);
+    }
+    void attach(int node, int via, double distance);
+    void touch(int node, ShortestPathWorkspace &ws, std::vector<int> &changed);
+    void propagate(const ContactGraph &graph, ShortestPathWorkspace &ws,
+                   std::vector<int> &changed);
+};
+
+#endif
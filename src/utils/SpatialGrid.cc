@@ -0,0 +1,66 @@
+#include "SpatialGrid.h"
+
+void SpatialGrid::build(const std::vector<double> &x, const std::vector<double> &y,
+                        const std::vector<double> &z, double size) {
+    cellSize = size;
+    invCellSize = 1.0 / size;
+
+    size_t n = x.size();
+    uint32_t tableSize = 16;
+    while (tableSize < 2 * n)
+        tableSize *= 2;
+    mask = tableSize - 1;
+
+    // Counting sort of the points by bucket
+    std::vector<uint32_t> bucket(n);
+    bucketStart.assign(tableSize + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        bucket[i] = bucketOf(cellCoord(x[i]), cellCoord(y[i]), cellCoord(z[i]));
+        bucketStart[bucket[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < tableSize; b++)
+        bucketStart[b + 1] += bucketStart[b];
+
+    index.resize(n);
+    cx.resize(n);
+    cy.resize(n);
+    cz.resize(n);
+    px.resize(n);
+    py.resize(n);
+    pz.resize(n);
+
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t k = fill[bucket[i]]++;
+        index[k] = i;
+        cx[k] = cellCoord(x[i]);
+        cy[k] = cellCoord(y[i]);
+        cz[k] = cellCoord(z[i]);
+        px[k] = x[i];
+        py[k] = y[i];
+        pz[k] = z[i];
+    }
+}
+
+int SpatialGrid::nearestWithin(const Position3D &p, double radius, double &distance,
+                               int exclude) const {
+    // Grow the search sphere from one cell: the nearest point inside a
+    // sphere is the global nearest, so the first non-empty pass is exact
+    // and dense constellations never scan the full 'radius'.
+    double r = radius < cellSize ? radius : cellSize;
+    while (true) {
+        int best = -1;
+        distance = r;
+        forEachWithin(p, r, [&](int i, double d) {
+            if (i == exclude)
+                return;
+            if (best < 0 || d < distance || (d == distance && i < best)) {
+                best = i;
+                distance = d;
+            }
+        });
+        if (best >= 0 || r >= radius)
+            return best;
+        r = (2 * r < radius) ? 2 * r : radius;
+    }
+}
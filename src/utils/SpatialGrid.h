@@ -0,0 +1,77 @@
+#ifndef __MY_LEO_SPATIALGRID_H
+#define __MY_LEO_SPATIALGRID_H
+
+#include "PositionUtils.h"
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over ECEF points (satellite positions of one tick) for
+// fixed-radius queries. Cells are cubes of 'cellSize' km, hashed into a
+// table sized to the number of points, so memory is O(n) whatever the
+// orbit altitudes. Points are stored cell-sorted for cache-friendly scans.
+// A query visits only the cells overlapping the query sphere's bounding
+// box, i.e. O(cells + nearby points) instead of O(n).
+class SpatialGrid {
+
+public:
+    // (Re)build from SoA coordinates. O(n).
+    void build(const std::vector<double> &x, const std::vector<double> &y,
+               const std::vector<double> &z, double cellSize);
+
+    size_t size() const { return index.size(); }
+    double getCellSize() const { return cellSize; }
+
+    // Call fn(pointIndex, distance) for every point within 'radius' of 'p'.
+    // Order is unspecified.
+    template <typename Fn>
+    void forEachWithin(const Position3D &p, double radius, Fn fn) const;
+
+    // Closest point within 'radius' of 'p' (ties: lowest index), -1 if none.
+    // Point 'exclude' (if >= 0) is never returned.
+    int nearestWithin(const Position3D &p, double radius, double &distance,
+                      int exclude = -1) const;
+
+private:
+    double cellSize = 1.0;
+    double invCellSize = 1.0;
+    uint32_t mask = 0;
+
+    std::vector<uint32_t> bucketStart;     // CSR offsets, mask + 2 entries
+    std::vector<int> index;                // original point index, cell-sorted
+    std::vector<int32_t> cx, cy, cz;       // cell coordinates, cell-sorted
+    std::vector<double> px, py, pz;        // coordinates, cell-sorted
+
+    int32_t cellCoord(double v) const { return (int32_t)std::floor(v * invCellSize); }
+    uint32_t bucketOf(int32_t ix, int32_t iy, int32_t iz) const {
+        return ((uint32_t)ix * 73856093u ^ (uint32_t)iy * 19349663u ^ (uint32_t)iz * 83492791u) & mask;
+    }
+};
+
+template <typename Fn>
+void SpatialGrid::forEachWithin(const Position3D &p, double radius, Fn fn) const {
+    if (index.empty())
+        return;
+    double radius2 = radius * radius;
+    int32_t x0 = cellCoord(p.x - radius), x1 = cellCoord(p.x + radius);
+    int32_t y0 = cellCoord(p.y - radius), y1 = cellCoord(p.y + radius);
+    int32_t z0 = cellCoord(p.z - radius), z1 = cellCoord(p.z + radius);
+
+    for (int32_t ix = x0; ix <= x1; ix++) {
+        for (int32_t iy = y0; iy <= y1; iy++) {
+            for (int32_t iz = z0; iz <= z1; iz++) {
+                uint32_t b = bucketOf(ix, iy, iz);
+                for (uint32_t k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                    // Several cells may share a bucket; each point belongs to one cell
+                    if (cx[k] != ix || cy[k] != iy || cz[k] != iz)
+                        continue;
+                    double dx = px[k] - p.x, dy = py[k] - p.y, dz = pz[k] - p.z;
+                    double d2 = dx * dx + dy * dy + dz * dz;
+                    if (d2 <= radius2)
+                        fn(index[k], std::sqrt(d2));
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int numThreads) {
+    for (int i = 1; i < numThreads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCond.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::runRange(int threadIndex) {
+    size_t numThreads = getNumThreads();
+    size_t begin = jobSize * threadIndex / numThreads;
+    size_t end = jobSize * (threadIndex + 1) / numThreads;
+    if (begin < end)
+        (*currentJob)(begin, end, threadIndex);
+}
+
+void ThreadPool::workerLoop(int threadIndex) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCond.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        runRange(threadIndex);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0)
+            doneCond.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t, size_t, int)> &job) {
+    if (workers.empty()) {
+        if (n > 0)
+            job(0, n, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentJob = &job;
+        jobSize = n;
+        pending = workers.size();
+        generation++;
+    }
+    startCond.notify_all();
+
+    runRange(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCond.wait(lock, [&] { return pending == 0; });
+    currentJob = nullptr;
+}
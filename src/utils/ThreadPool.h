@@ -0,0 +1,46 @@
+#ifndef __MY_LEO_THREADPOOL_H
+#define __MY_LEO_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal fork/join pool for data-parallel numeric work (batch propagation,
+// per-source shortest paths). Workers are started once and reused; the
+// calling thread takes part in every parallelFor(), so a pool of N threads
+// starts N-1 workers. Jobs must not touch OMNeT++ objects.
+class ThreadPool {
+
+public:
+  explicit ThreadPool(int numThreads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int getNumThreads() const { return workers.size() + 1; }
+
+  // Split [0, n) into one contiguous range per thread and run
+  // job(begin, end, threadIndex) on each. Returns when all ranges are done.
+  void parallelFor(size_t n, const std::function<void(size_t, size_t, int)> &job);
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable startCond;
+  std::condition_variable doneCond;
+
+  const std::function<void(size_t, size_t, int)> *currentJob = nullptr;
+  size_t jobSize = 0;
+  unsigned long generation = 0;
+  int pending = 0;
+  bool stopping = false;
+
+  void workerLoop(int threadIndex);
+  void runRange(int threadIndex);
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "TleReader.h"
+#include "Sgp4.h"
+#include <cstdlib>
+#include <cstring>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+TleReader::TleReader(const std::string &path) : in(path) {}
+
+// Parse the fixed-width field [col, col+len) (1-based column) as a number.
+// 'impliedPoint' handles fields written without a leading "0." (eccentricity).
+static double field(const std::string &line, int col, int len, bool impliedPoint = false) {
+    char buf[24];
+    int n = 0;
+    if (impliedPoint) {
+        buf[n++] = '.';
+    }
+    for (int i = col - 1; i < col - 1 + len && i < (int)line.size() && n < (int)sizeof(buf) - 1; i++) {
+        if (line[i] != ' ')
+            buf[n++] = line[i];
+    }
+    buf[n] = '\0';
+    return strtod(buf, nullptr);
+}
+
+// BSTAR uses an assumed-decimal mantissa and exponent: " 34123-4" = 0.34123e-4
+static double assumedDecimal(const std::string &line, int col) {
+    double mantissa = field(line, col + 1, 5, true);
+    if (line[col - 1] == '-')
+        mantissa = -mantissa;
+    int exponent = (int)field(line, col + 6, 2);
+    return mantissa * pow(10.0, exponent);
+}
+
+bool TleReader::checksumOk(const std::string &line) {
+    if (line.size() < 69)
+        return false;
+    int sum = 0;
+    for (int i = 0; i < 68; i++) {
+        char c = line[i];
+        if (c >= '0' && c <= '9')
+            sum += c - '0';
+        else if (c == '-')
+            sum += 1;
+    }
+    return line[68] - '0' == sum % 10;
+}
+
+bool TleReader::parse(const std::string &line1, const std::string &line2, TleRecord &record) {
+    if (line1.size() < 69 || line2.size() < 69 || line1[0] != '1' || line2[0] != '2')
+        return false;
+    if (!checksumOk(line1) || !checksumOk(line2))
+        return false;
+
+    record.catalogNumber = (int)field(line1, 3, 5);
+
+    // Epoch: 2-digit year (57-99 = 19xx) and fractional day of year
+    int yy = (int)field(line1, 19, 2);
+    int year = yy < 57 ? 2000 + yy : 1900 + yy;
+    double dayOfYear = field(line1, 21, 12);
+    double jan0 = 367.0 * year - floor(7.0 * year * 0.25) + 30.0 + 1721013.5; // JD of Jan 0.0
+    record.epochJulianDate = jan0 + dayOfYear;
+    record.bstar = assumedDecimal(line1, 54);
+
+    record.inclination = field(line2, 9, 8);
+    record.raan = field(line2, 18, 8);
+    record.eccentricity = field(line2, 27, 7, true);
+    record.argPerigee = field(line2, 35, 8);
+    record.meanAnomaly = field(line2, 44, 8);
+    record.meanMotion = field(line2, 53, 11);
+    record.line1 = line1;
+    record.line2 = line2;
+
+    return record.meanMotion > 0 && record.eccentricity < 1.0;
+}
+
+bool TleReader::next(TleRecord &record) {
+    std::string line, title;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+
+        if (line[0] != '1' || line.size() < 2 || line[1] != ' ') {
+            title = line; // 3-line format: remember the name
+            continue;
+        }
+
+        std::string line2;
+        if (!std::getline(in, line2))
+            return false;
+        if (!line2.empty() && line2.back() == '\r')
+            line2.pop_back();
+
+        if (parse(line, line2, record)) {
+            size_t end = title.find_last_not_of(' ');
+            record.name = (end == std::string::npos) ? "" : title.substr(0, end + 1);
+            if (record.name.compare(0, 2, "0 ") == 0)
+                record.name.erase(0, 2);
+            return true;
+        }
+        numRejected++;
+        title.clear();
+    }
+    return false;
+}
+
+double greenwichSiderealTime(double julianDate) {
+    double tut1 = (julianDate - 2451545.0) / 36525.0;
+    double seconds = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+                     (876600.0 * 3600.0 + 8640184.812866) * tut1 + 67310.54841;
+    double gmst = fmod(seconds * (M_PI / 180.0) / 240.0, 2 * M_PI);
+    return gmst < 0 ? gmst + 2 * M_PI : gmst;
+}
+
+static double wrapDegrees(double angle) {
+    angle = fmod(angle, 360.0);
+    return angle < 0 ? angle + 360.0 : angle;
+}
+
+OrbitParams tleToOrbitParams(const TleRecord &record, double referenceJulianDate) {
+    double dt = (referenceJulianDate - record.epochJulianDate) * 86400.0;
+    const double deg = 180.0 / M_PI;
+
+    // Secular rates (rad/min); deep space sets only get the mean motion
+    Sgp4Record sgp4;
+    double brouwer = sgp4BrouwerMeanMotion(record);
+    double mdot = brouwer, argpdot = 0, nodedot = 0;
+    if (sgp4Init(record, dt, sgp4)) {
+        mdot = sgp4.mdot;
+        argpdot = sgp4.argpdot;
+        nodedot = sgp4.nodedot;
+    }
+    double n = brouwer / 60.0; // rad/s
+    double minutes = dt / 60.0;
+
+    OrbitParams params;
+    params.semiMajorAxis = cbrt(EARTH_GRAVITATIONAL_MU / (n * n));
+    params.eccentricity = record.eccentricity;
+    params.inclination = record.inclination;
+    params.raan = wrapDegrees(record.raan + nodedot * minutes * deg -
+                              greenwichSiderealTime(referenceJulianDate) * deg);
+    params.argPerigee = wrapDegrees(record.argPerigee + argpdot * minutes * deg);
+
+    // makeOrbitState() takes 'trueAnomaly' as the mean anomaly at t = 0
+    params.trueAnomaly = wrapDegrees(record.meanAnomaly + mdot * minutes * deg);
+    return params;
+}
@@ -0,0 +1,60 @@
+#ifndef __MY_LEO_TLEREADER_H
+#define __MY_LEO_TLEREADER_H
+
+#include "PositionUtils.h"
+#include <fstream>
+#include <string>
+
+// One NORAD two-line element set (mean elements at 'epoch')
+struct TleRecord {
+  std::string name;        // optional title line, may be empty
+  int catalogNumber;
+  double epochJulianDate;  // UTC
+  double inclination;      // degrees
+  double raan;             // degrees (true-of-date inertial frame)
+  double eccentricity;
+  double argPerigee;       // degrees
+  double meanAnomaly;      // degrees
+  double meanMotion;       // revolutions per day
+  double bstar;            // drag term (1/earth radii)
+  std::string line1, line2; // the element set as read, for SGP4 (Sgp4.h)
+};
+
+// Streams a TLE file one element set at a time, so large catalogs are never
+// held in memory. Accepts both 2-line and 3-line (with title) formats.
+class TleReader {
+
+public:
+  explicit TleReader(const std::string &path);
+
+  bool isOpen() const { return in.is_open(); }
+
+  // Read the next element set. Returns false at end of file.
+  // Malformed sets are skipped and counted in getNumRejected().
+  bool next(TleRecord &record);
+
+  int getNumRejected() const { return numRejected; }
+
+  // Parse one element set (name is left empty). Returns false if malformed.
+  static bool parse(const std::string &line1, const std::string &line2, TleRecord &record);
+
+private:
+  std::ifstream in;
+  int numRejected = 0;
+
+  static bool checksumOk(const std::string &line);
+};
+
+// Greenwich mean sidereal time (rad) at a UT1 Julian date (IAU-82)
+double greenwichSiderealTime(double julianDate);
+
+// Convert a TLE to the simulation's OrbitParams, with simulation time 0 at
+// 'referenceJulianDate'. The semi-major axis comes from the Brouwer mean
+// motion (un-Kozai'd, as in SGP4), the angles are advanced from the TLE
+// epoch to the reference epoch with the SGP4 secular rates, and RAAN is
+// shifted by GMST at the reference epoch because the propagator assumes
+// Greenwich is at angle 0 when t = 0. Only a J2 secular approximation of
+// the element set: drag and periodic terms need SGP4 itself.
+OrbitParams tleToOrbitParams(const TleRecord &record, double referenceJulianDate);
+
+#endif